@@ -0,0 +1,233 @@
+/*
+================================================================================
+Random-Walk Engine for sample_algo_1
+================================================================================
+
+struct WalkRng
+    - splitmix64; cheap, seedable, one per thread or per block of walks
+
+struct WalkScratch
+    - OPEN list, epoch-stamped "in path" marks; reused across walks so a walk
+      allocates nothing
+
+WalkResult random_walk(g, start, goal, rng, scratch, loops_per_node)
+    - one walk as in sample_algo_1: pick a random OPEN entry (removed by
+      swapping with the last, O(1)), count it as a loop if already in the
+      path, stop at the goal, push every neighbor (loops counted the same)
+    - loops_per_node, when given, is a dense counter per node that the walk
+      adds to
+
+WalkDistribution run_walks(g, start, goal, walks, threads, seed)
+    - many independent walks for hitting-time and loop-count statistics;
+      walks are cut into fixed blocks, each with its own generator seeded
+      from (seed, block), and threads take blocks in turn, so the result
+      depends on the seed but not on the thread count
+
+================================================================================
+*/
+
+#pragma once
+#include "util.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct WalkRng {
+  uint64_t state;
+
+  explicit WalkRng(uint64_t seed) : state(seed) {}
+
+  uint64_t next() {
+    uint64_t z = state += 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+  }
+
+  // Uniform in [0, n) by multiply-shift; no division on the hot path.
+  int below(int n) { return int(((next() >> 32) * uint64_t(n)) >> 32); }
+};
+
+struct WalkScratch {
+  vector<int> open;
+  vector<uint32_t> in_path; // == epoch when the node is in this walk's path
+  uint32_t epoch = 0;
+
+  void begin(int n) {
+    open.clear();
+    if ((int)in_path.size() != n)
+      in_path.assign(n, 0);
+    if (++epoch == 0) {
+      fill(in_path.begin(), in_path.end(), 0);
+      epoch = 1;
+    }
+  }
+};
+
+struct WalkResult {
+  bool success = false;
+  int steps = 0;
+  long long loops = 0; // loop/cycle counts over all nodes
+};
+
+inline WalkResult random_walk(const Graph &g, int start, int goal,
+                              WalkRng &rng, WalkScratch &s,
+                              vector<long long> *loops_per_node = nullptr) {
+  WalkResult r;
+  int n = g.size();
+  s.begin(n);
+  auto loop = [&](int node) {
+    r.loops++;
+    if (loops_per_node)
+      (*loops_per_node)[node]++;
+  };
+  int max_steps = n * 100;
+  s.open.push_back(start);
+  while (!s.open.empty() && r.steps < max_steps) {
+    int idx = rng.below(s.open.size());
+    int node = s.open[idx];
+    s.open[idx] = s.open.back();
+    s.open.pop_back();
+
+    if (s.in_path[node] == s.epoch)
+      loop(node);
+    s.in_path[node] = s.epoch;
+
+    r.steps++;
+    if (node == goal) {
+      r.success = true;
+      return r;
+    }
+    for (int nb : g.neighbors(node)) {
+      if (s.in_path[nb] == s.epoch)
+        loop(nb);
+      s.open.push_back(nb);
+    }
+  }
+  return r;
+}
+
+// Histograms indexed by value: hitting_time[s] counts successful walks that
+// took s steps, loops[c] counts walks with c loop/cycle counts.
+struct WalkDistribution {
+  long long walks = 0;
+  long long successes = 0;
+  vector<long long> hitting_time;
+  vector<long long> loops;
+  vector<long long> loops_per_node; // summed over all walks
+
+  void add(const WalkDistribution &o) {
+    walks += o.walks;
+    successes += o.successes;
+    merge(hitting_time, o.hitting_time);
+    merge(loops, o.loops);
+    merge(loops_per_node, o.loops_per_node);
+  }
+
+  // Smallest step count within which a fraction p of successful walks hit
+  // the goal.
+  int hitting_percentile(double p) const { return percentile(hitting_time, p); }
+  int loops_percentile(double p) const { return percentile(loops, p); }
+  double mean_hitting_time() const { return mean(hitting_time); }
+  double mean_loops() const { return mean(loops); }
+
+private:
+  static void merge(vector<long long> &into, const vector<long long> &from) {
+    if (into.size() < from.size())
+      into.resize(from.size(), 0);
+    for (size_t i = 0; i < from.size(); i++)
+      into[i] += from[i];
+  }
+
+  static int percentile(const vector<long long> &h, double p) {
+    long long total = 0;
+    for (long long c : h)
+      total += c;
+    long long want = (long long)(p * total + 0.5), seen = 0;
+    for (size_t v = 0; v < h.size(); v++)
+      if ((seen += h[v]) >= max(want, 1LL))
+        return v;
+    return 0;
+  }
+
+  static double mean(const vector<long long> &h) {
+    double sum = 0, total = 0;
+    for (size_t v = 0; v < h.size(); v++) {
+      sum += double(v) * h[v];
+      total += h[v];
+    }
+    return total > 0 ? sum / total : 0;
+  }
+};
+
+const long long WALK_BLOCK = 4096; // walks per generator seed
+
+inline WalkDistribution run_walks(const Graph &g, int start, int goal,
+                                  long long walks, int threads,
+                                  uint64_t seed) {
+  if (threads <= 0)
+    threads = max(1u, thread::hardware_concurrency());
+  g.pack(); // before the threads read it
+  long long blocks = (walks + WALK_BLOCK - 1) / WALK_BLOCK;
+  atomic<long long> next_block(0);
+  WalkDistribution total;
+  total.loops_per_node.assign(g.size(), 0);
+  mutex mtx;
+
+  auto worker = [&]() {
+    WalkDistribution d;
+    d.loops_per_node.assign(g.size(), 0);
+    WalkScratch scratch;
+    for (long long b; (b = next_block++) < blocks;) {
+      WalkRng rng(seed ^ (uint64_t(b) * 0xd1b54a32d192ed03ULL));
+      long long end = min(walks, (b + 1) * WALK_BLOCK);
+      for (long long w = b * WALK_BLOCK; w < end; w++) {
+        WalkResult r =
+            random_walk(g, start, goal, rng, scratch, &d.loops_per_node);
+        d.walks++;
+        if (r.success) {
+          d.successes++;
+          if ((int)d.hitting_time.size() <= r.steps)
+            d.hitting_time.resize(r.steps + 1, 0);
+          d.hitting_time[r.steps]++;
+        }
+        if ((long long)d.loops.size() <= r.loops)
+          d.loops.resize(r.loops + 1, 0);
+        d.loops[r.loops]++;
+      }
+    }
+    lock_guard<mutex> lock(mtx);
+    total.add(d);
+  };
+
+  vector<thread> pool;
+  for (int t = 1; t < threads; t++)
+    pool.emplace_back(worker);
+  worker();
+  for (auto &t : pool)
+    t.join();
+  return total;
+}
+
+inline void print_walk_distribution(const WalkDistribution &d,
+                                    ostream &out = cout) {
+  out << "Walks: " << d.walks << ", reached goal: " << d.successes << " ("
+      << (d.walks ? 100.0 * d.successes / d.walks : 0) << "%)\n";
+  if (d.successes > 0)
+    out << "Hitting time (steps): mean " << d.mean_hitting_time()
+        << ", median " << d.hitting_percentile(0.5) << ", p90 "
+        << d.hitting_percentile(0.9) << ", p99 " << d.hitting_percentile(0.99)
+        << ", max " << d.hitting_time.size() - 1 << "\n";
+  out << "Loop counts per walk: mean " << d.mean_loops() << ", median "
+      << d.loops_percentile(0.5) << ", p90 " << d.loops_percentile(0.9)
+      << ", p99 " << d.loops_percentile(0.99) << "\n";
+  out << "Mean loop counts per node:\n";
+  for (size_t i = 0; i < d.loops_per_node.size(); i++)
+    if (d.loops_per_node[i] > 0)
+      out << node_label(i) << ": " << double(d.loops_per_node[i]) / d.walks
+          << "\n";
+}
@@ -1,9 +1,9 @@
+// g++ -O2 -std=c++17 -pthread sample_algo_1.cpp -o sample_algo_1
+#include "random_walk.h"
 #include "util.h"
 #include <cctype>
 #include <cstdlib>
 #include <ctime>
-#include <map>
-#include <unordered_set>
 #include <vector>
 
 // Converts a lowercase character ('a'-'j') to node index (0-9)
@@ -21,51 +21,15 @@ char index_to_char(int idx) {
 
 // Random walk: counts cycles, but does NOT abort on encountering a cycle
 // Returns true if goal node is found, false otherwise
-// Also returns how many steps it took and cycle counts per node
+// Also returns how many steps it took and cycle counts per node (dense,
+// indexed by node). The walk itself is random_walk() in random_walk.h.
 bool sample_algo_1(Graph &graph, int start, int goal, int &steps_taken,
-                   std::map<char, int> &loop_counts) {
-  std::vector<int> OPEN;
-  std::unordered_set<int> in_path;
-
-  OPEN.push_back(start);
-  loop_counts.clear();
-  std::srand((unsigned)std::time(nullptr));
-  steps_taken = 0;
-  int max_steps = graph.nodes.size() * 100; // increased to allow more wandering
-
-  while (!OPEN.empty() && steps_taken < max_steps) {
-    // Pick a random node from OPEN
-    int idx = std::rand() % OPEN.size();
-    int node_idx = OPEN[idx];
-    // Remove node from OPEN
-    OPEN.erase(OPEN.begin() + idx);
-
-    // If node already in path, count as loop but do NOT abort
-    if (in_path.count(node_idx)) {
-      loop_counts[index_to_char(node_idx)]++;
-    }
-
-    // Add to path (if not already)
-    in_path.insert(node_idx);
-
-    // Goal test
-    if (node_idx == goal) {
-      steps_taken++;
-      return true;
-    }
-
-    // Explore neighbors: add all neighbors to OPEN, even if already present
-    for (int nb : graph.nodes[node_idx]->neighbors) {
-      // If neighbor is already in path, increment loop count
-      if (in_path.count(nb)) {
-        loop_counts[index_to_char(nb)]++;
-      }
-      OPEN.push_back(nb);
-    }
-
-    steps_taken++;
-  }
-  return false;
+                   std::vector<long long> &loop_counts, WalkRng &rng) {
+  static WalkScratch scratch;
+  loop_counts.assign(graph.size(), 0);
+  WalkResult r = random_walk(graph, start, goal, rng, scratch, &loop_counts);
+  steps_taken = r.steps;
+  return r.success;
 }
 
 void print_menu() {
@@ -73,7 +37,9 @@ void print_menu() {
   std::cout << "1. Print graph (pretty DFS)\n";
   std::cout << "2. Print adjacency list\n";
   std::cout << "3. Search for goal node (random walk, counts cycles, steps)\n";
-  std::cout << "4. Exit\n";
+  std::cout << "4. Monte Carlo walks (hitting-time and loop-count "
+               "distributions)\n";
+  std::cout << "5. Exit\n";
   std::cout << "Enter your choice: ";
 }
 
@@ -90,6 +56,8 @@ int main() {
   g.addEdge(8, 9); // i-j
   g.addEdge(9, 1); // j-b (cycle)
 
+  // Seeded once; every walk continues the same stream.
+  WalkRng rng((uint64_t)std::time(nullptr));
   int choice = 0;
   while (true) {
     print_menu();
@@ -109,11 +77,11 @@ int main() {
         std::cout << "Invalid node.\n";
         continue;
       }
-      std::map<char, int> loop_counts;
+      std::vector<long long> loop_counts;
       int steps_taken = 0;
       std::cout << "\nSearch for goal node '" << index_to_char(goal)
                 << "' (random walk, counts cycles, steps):\n";
-      bool success = sample_algo_1(g, 0, goal, steps_taken, loop_counts);
+      bool success = sample_algo_1(g, 0, goal, steps_taken, loop_counts, rng);
       if (success) {
         std::cout << "Search success.\n";
         std::cout << "Total steps taken to reach goal: " << steps_taken << "\n";
@@ -122,10 +90,33 @@ int main() {
         std::cout << "Total steps tried: " << steps_taken << "\n";
       }
       std::cout << "Loop/cycle counts from each movegen:\n";
-      for (const auto &entry : loop_counts) {
-        std::cout << entry.first << ": " << entry.second << "\n";
+      for (size_t i = 0; i < loop_counts.size(); i++) {
+        if (loop_counts[i] > 0)
+          std::cout << index_to_char(i) << ": " << loop_counts[i] << "\n";
       }
     } else if (choice == 4) {
+      char goal_ch;
+      long long walks;
+      int threads;
+      uint64_t seed;
+      std::cout << "Enter goal node (a-j): ";
+      std::cin >> goal_ch;
+      int goal = char_to_index(goal_ch);
+      if (goal == -1) {
+        std::cout << "Invalid node.\n";
+        continue;
+      }
+      std::cout << "Number of walks: ";
+      std::cin >> walks;
+      std::cout << "Threads (0 = all cores): ";
+      std::cin >> threads;
+      std::cout << "Seed: ";
+      std::cin >> seed;
+      WalkDistribution d = run_walks(g, 0, goal, walks, threads, seed);
+      std::cout << "\nMonte Carlo walks to goal node '" << index_to_char(goal)
+                << "':\n";
+      print_walk_distribution(d);
+    } else if (choice == 5) {
       std::cout << "Exiting. Goodbye!\n";
       break;
     } else {
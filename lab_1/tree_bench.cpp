@@ -0,0 +1,83 @@
+/*
+================================================================================
+Graph / toTree benchmark
+================================================================================
+
+    ./tree_bench [nodes] [degree] [seed]
+
+Builds a random connected graph (a random spanning tree plus extra edges up
+to the average degree), then times addEdge + pack and toTree in BFS and DFS
+order and reports the bytes held by the graph and by each tree. Defaults to
+one million nodes of degree 4.
+
+================================================================================
+*/
+
+#include "util.h"
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+static double seconds_since(chrono::steady_clock::time_point t0) {
+  return chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+}
+
+// Reads all of `text` as a base-10 number; false on an empty string,
+// trailing characters or a value that does not fit.
+template <class T> static bool parse_number(const char *text, T &value) {
+  const char *end = text + strlen(text);
+  T parsed{};
+  auto [last, ec] = from_chars(text, end, parsed);
+  if (last == text || ec != errc() || last != end)
+    return false;
+  value = parsed;
+  return true;
+}
+
+int main(int argc, char **argv) {
+  int n = 1000000, degree = 4;
+  uint64_t seed = 1;
+  bool ok = (argc <= 1 || parse_number(argv[1], n)) &&
+            (argc <= 2 || parse_number(argv[2], degree)) &&
+            (argc <= 3 || parse_number(argv[3], seed));
+  if (!ok || n < 1 || degree < 2) {
+    cout << "Usage: tree_bench [nodes >= 1] [degree >= 2] [seed]\n";
+    return 1;
+  }
+  uint64_t state = seed;
+  auto below = [&](int bound) {
+    uint64_t z = state += 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return int(((z ^ (z >> 31)) >> 32) * uint64_t(bound) >> 32);
+  };
+
+  auto t0 = chrono::steady_clock::now();
+  Graph g(n);
+  for (int u = 1; u < n; u++)
+    g.addEdge(u, below(u)); // keeps the graph connected
+  long long extra = (long long)n * degree / 2 - (n - 1);
+  for (long long e = 0; e < extra; e++)
+    g.addEdge(below(n), below(n));
+  g.pack();
+  double build = seconds_since(t0);
+
+  cout << "Nodes: " << n << ", average degree: " << degree << "\n";
+  cout << "Graph build + pack: " << build * 1e3 << " ms, "
+       << g.memoryBytes() / 1024 << " KiB\n";
+
+  for (TreeOrder order : {TREE_BFS, TREE_DFS}) {
+    t0 = chrono::steady_clock::now();
+    Tree *tree = g.toTree(0, order);
+    double took = seconds_since(t0);
+    int height = 0;
+    for (const TreeNode &t : tree->nodes)
+      height = max(height, t.depth);
+    cout << (order == TREE_BFS ? "toTree BFS: " : "toTree DFS: ") << took * 1e3
+         << " ms, " << tree->nodes.size() << " tree nodes, height " << height
+         << ", " << tree->memoryBytes() / 1024 << " KiB\n";
+  }
+  return 0;
+}
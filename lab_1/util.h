@@ -1,85 +1,263 @@
 /*
 ================================================================================
-Graph and Node Classes with TWO Print Functions
+Graph and Tree Classes with TWO Print Functions
 ================================================================================
 
 class Graph
     - Graph(int n)
     - void addEdge(int u, int v)
-    - void printAdjacencyList() // shows all edges (including cycles)
-    - void printGraph(int start = 0) // pretty DFS print, shows one path per
-node
+    - int size()
+    - Neighbors neighbors(int u) // contiguous slice of the adjacency array
+    - void pack() // builds the adjacency array; call before sharing the
+                  // graph between threads (neighbors() packs on demand)
+    - void printAdjacencyList(ostream &out = cout) // shows all edges
+                  // (including cycles)
+    - void printGraph(int start = 0, ostream &out = cout) // pretty DFS
+                  // print, shows one path per node
+    - Tree *toTree(int root, TreeOrder order = TREE_BFS) // spanning tree,
+                  // owned by the graph until the next toTree call
+    - size_t memoryBytes()
 
-struct Node
-    - int data
-    - vector<int> neighbors
+class Tree
+    - vector<TreeNode> nodes // one arena; nodes[0] is the root
+    - vector<int> children   // each node's children, contiguous
+    - int root
+    - void printTree(int node, ostream &out = cout) // same drawing as
+                  // printGraph
+    - size_t memoryBytes()
+
+Storage is flat: edges are kept in one list while the graph is built and
+packed into an offsets / adjacency array pair (CSR) on first use, so a graph
+or tree of any size is a handful of allocations. toTree and the printers use
+explicit stacks, so million-node trees do not hit recursion limits, and the
+printers reuse one prefix buffer and end lines with '\n' rather than endl:
+nothing is flushed per line, so a dump to a file or pipe goes out in large
+blocks.
 
 ================================================================================
 */
 
+#pragma once
 #include <algorithm>
 #include <cstdlib>
 #include <ctime>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <set>
 #include <string>
+#include <utility>
 #include <vector>
 using namespace std;
 
-struct Node {
-  int data;
-  vector<int> neighbors;
-  Node(int val) : data(val) {}
+// Letter names for the small demo graphs, numbers beyond 'z'.
+inline string node_label(int i) {
+  return i < 26 ? string(1, char('a' + i)) : to_string(i);
+}
+
+struct TreeNode {
+  int data;        // graph node this tree node stands for
+  int parent;      // index in Tree::nodes, -1 for the root
+  int depth;
+  int firstChild;  // index in Tree::children
+  int childCount;
 };
 
-class Graph {
+class Tree {
 public:
-  vector<Node *> nodes;
+  vector<TreeNode> nodes;
+  vector<int> children;
+  int root = 0;
 
-  Graph(int n) {
-    for (int i = 0; i < n; ++i)
-      nodes.push_back(new Node(i));
+  size_t memoryBytes() const {
+    return nodes.capacity() * sizeof(TreeNode) +
+           children.capacity() * sizeof(int);
   }
 
+  // Pretty print of the subtree under `node`, iteratively. One prefix
+  // buffer is cut back to the parent's length for every line.
+  void printTree(int node, ostream &out = cout) const {
+    vector<pair<int, bool>> stack{{node, true}}; // (node, isLast)
+    vector<size_t> cut{0}; // prefix length at each depth below `node`
+    string prefix;
+    int base = nodes[node].depth;
+    while (!stack.empty()) {
+      auto [u, isLast] = stack.back();
+      stack.pop_back();
+      const TreeNode &t = nodes[u];
+      int depth = t.depth - base;
+      prefix.resize(cut[depth]);
+      out << prefix << (isLast ? "└── " : "├── ") << node_label(t.data)
+          << '\n';
+      if (t.childCount == 0)
+        continue;
+      prefix += isLast ? "    " : "│   ";
+      cut.resize(depth + 2);
+      cut[depth + 1] = prefix.size();
+      for (int c = t.childCount - 1; c >= 0; c--)
+        stack.push_back({children[t.firstChild + c], c == t.childCount - 1});
+    }
+  }
+};
+
+enum TreeOrder { TREE_BFS, TREE_DFS };
+
+class Graph {
+public:
+  // Range over one node's neighbors in the packed adjacency array.
+  struct Neighbors {
+    const int *first, *last;
+    const int *begin() const { return first; }
+    const int *end() const { return last; }
+    int size() const { return int(last - first); }
+  };
+
+  Graph(int n) : n(n) {}
+
+  int size() const { return n; }
+
   void addEdge(int u, int v) {
-    nodes[u]->neighbors.push_back(v);
-    nodes[v]->neighbors.push_back(u); // undirected
+    edges.push_back({u, v});
+    edges.push_back({v, u}); // undirected
+    packed = false;
+  }
+
+  // Counting sort of the edge list by source; each node keeps its
+  // neighbors in the order their edges were added.
+  void pack() const {
+    if (packed)
+      return;
+    offsets.assign(n + 1, 0);
+    for (auto &e : edges)
+      offsets[e.first + 1]++;
+    for (int u = 0; u < n; u++)
+      offsets[u + 1] += offsets[u];
+    adjacency.resize(edges.size());
+    vector<int> fill(offsets.begin(), offsets.end() - 1);
+    for (auto &e : edges)
+      adjacency[fill[e.first]++] = e.second;
+    packed = true;
+  }
+
+  Neighbors neighbors(int u) const {
+    pack();
+    return {adjacency.data() + offsets[u], adjacency.data() + offsets[u + 1]};
+  }
+
+  size_t memoryBytes() const {
+    return edges.capacity() * sizeof(pair<int, int>) +
+           offsets.capacity() * sizeof(int) +
+           adjacency.capacity() * sizeof(int) +
+           (tree ? tree->memoryBytes() : 0);
   }
 
   // Print adjacency list: shows all connections including cycles
-  void printAdjacencyList() {
-    cout << "\nAdjacency List:\n";
-    for (auto node : nodes) {
-      cout << char('a' + node->data) << ": ";
-      for (int nb : node->neighbors)
-        cout << char('a' + nb) << " ";
-      cout << endl;
+  void printAdjacencyList(ostream &out = cout) {
+    out << "\nAdjacency List:\n";
+    for (int u = 0; u < n; u++) {
+      out << node_label(u) << ": ";
+      for (int nb : neighbors(u))
+        out << node_label(nb) << " ";
+      out << '\n';
     }
   }
 
   // Pretty DFS print (shows only first encounter of each node)
-  void printGraph(int start = 0) {
-    vector<bool> visited(nodes.size(), false);
-    printGraphPretty(start, visited, "", true);
+  // Iterative, with one prefix buffer, so deep graphs print without
+  // recursion or a string per line.
+  void printGraph(int start = 0, ostream &out = cout) {
+    struct Frame {
+      int node, next; // next neighbor to try
+      int printed, total; // children drawn so far, unvisited on entry
+      size_t prefixLen;
+      bool isLast;
+    };
+    vector<bool> visited(n, false);
+    vector<Frame> stack;
+    string prefix;
+    auto enter = [&](int u, bool isLast) {
+      visited[u] = true;
+      out << prefix << (isLast ? "└── " : "├── ") << node_label(u) << '\n';
+      int total = 0;
+      for (int nb : neighbors(u))
+        if (!visited[nb])
+          ++total;
+      stack.push_back({u, 0, 0, total, prefix.size(), isLast});
+    };
+    enter(start, true);
+    while (!stack.empty()) {
+      Frame &f = stack.back();
+      Neighbors nbs = neighbors(f.node);
+      while (f.next < nbs.size() && visited[nbs.begin()[f.next]])
+        f.next++;
+      if (f.next == nbs.size()) {
+        stack.pop_back();
+        continue;
+      }
+      int nb = nbs.begin()[f.next++];
+      bool isLast = ++f.printed == f.total;
+      prefix.resize(f.prefixLen);
+      prefix += f.isLast ? "    " : "│   ";
+      enter(nb, isLast);
+    }
   }
 
-private:
-  void printGraphPretty(int idx, vector<bool> &visited, string prefix,
-                        bool isLast) {
-    visited[idx] = true;
-    cout << prefix << (isLast ? "└── " : "├── ") << char('a' + nodes[idx]->data)
-         << endl;
-    int childPrinted = 0;
-    int total = 0;
-    for (int nb : nodes[idx]->neighbors)
-      if (!visited[nb])
-        ++total;
-    for (int nb : nodes[idx]->neighbors) {
-      if (!visited[nb]) {
-        printGraphPretty(nb, visited, prefix + (isLast ? "    " : "│   "),
-                         ++childPrinted == total);
+  // Spanning tree of the nodes reachable from `root`, in BFS (shortest hop
+  // paths) or DFS (the order printGraph walks) order. Built into one arena
+  // without recursion; the tree stays valid until the next call.
+  Tree *toTree(int root, TreeOrder order = TREE_BFS) {
+    tree = make_unique<Tree>();
+    vector<TreeNode> &nodes = tree->nodes;
+    vector<int> treeIndex(n, -1); // graph node -> tree node
+    auto add = [&](int u, int parent) {
+      treeIndex[u] = nodes.size();
+      int depth = parent == -1 ? 0 : nodes[parent].depth + 1;
+      nodes.push_back({u, parent, depth, 0, 0});
+    };
+    add(root, -1);
+    if (order == TREE_BFS) {
+      for (size_t head = 0; head < nodes.size(); head++)
+        for (int nb : neighbors(nodes[head].data))
+          if (treeIndex[nb] == -1)
+            add(nb, head);
+    } else {
+      vector<pair<int, int>> stack{{0, 0}}; // (tree node, next neighbor)
+      while (!stack.empty()) {
+        auto &[t, next] = stack.back();
+        Neighbors nbs = neighbors(nodes[t].data);
+        if (next == nbs.size()) {
+          stack.pop_back();
+          continue;
+        }
+        int nb = nbs.begin()[next++];
+        if (treeIndex[nb] == -1) {
+          add(nb, t);
+          stack.push_back({treeIndex[nb], 0});
+        }
       }
     }
+    // Children, grouped by parent in the order they joined the tree.
+    for (const TreeNode &t : nodes)
+      if (t.parent != -1)
+        nodes[t.parent].childCount++;
+    int pos = 0;
+    for (TreeNode &t : nodes) {
+      t.firstChild = pos;
+      pos += t.childCount;
+      t.childCount = 0;
+    }
+    tree->children.resize(nodes.size() - 1);
+    for (size_t i = 1; i < nodes.size(); i++) {
+      TreeNode &p = nodes[nodes[i].parent];
+      tree->children[p.firstChild + p.childCount++] = i;
+    }
+    return tree.get();
   }
+
+private:
+  int n;
+  vector<pair<int, int>> edges;
+  mutable vector<int> offsets, adjacency;
+  mutable bool packed = false;
+  unique_ptr<Tree> tree;
 };
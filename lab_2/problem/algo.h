@@ -7,12 +7,18 @@
 
     Algorithms included:
     - Breadth-First Search (BFS) [forward & reverse]
+    - Direction-optimizing BFS (top-down / bottom-up, bitmap frontiers)
     - Depth-First Search (DFS) [forward & reverse]
     - Bidirectional BFS
     - British Museum Search (all paths, exhaustive)
-    - Hill Climbing (greedy, heuristic-based)
+    - Hill Climbing (greedy, heuristic-based; plus an engine with
+   first-choice, random-restart and annealing modes on a thread pool)
     - Beam Search (heuristic-based, configurable width)
     - Best First Search (priority queue, heuristic-based)
+    - A* (weighted doors, indexed d-ary heap with decrease-key)
+    - IDA* (iterative-deepening A*, memory O(depth))
+    - Dijkstra (door costs; Dial's bucket queue or an indexed heap)
+    - K shortest simple paths (Yen's algorithm with Lawler's reuse)
 
     Input graph:
       Nodes represent rooms.
@@ -21,22 +27,40 @@
    algorithms).
 
     Usage:
-      - Each function prints the path found, nodes expanded, and complexity
-   analysis.
-      - All algorithms assume the input graph is loaded in either adjacency list
-   or edge list form.
+      - Each run* function returns a SearchResult (path, nodes expanded,
+   nodes generated, peak frontier size) without printing anything.
+      - The lowercase wrappers (bfs, dfs, ...) run the same search and print
+   the path found, nodes expanded, and complexity analysis.
+      - All algorithms run on the interned-id CSRGraph from csr.h. The
+   string-keyed adjacency map and the char-keyed `graph` overloads are thin
+   adapters that build a CSRGraph and forward to it.
 */
 
 #pragma once
+#include "bitmap.h"
+#include "bucket_queue.h"
+#include "csr.h"
+#include "indexed_heap.h"
+#include "instrument.h"
+#include "search_workspace.h"
+#include "thread_pool.h"
 #include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
 #include <fstream>
 #include <functional>
 #include <iostream>
+#include <limits>
 #include <map>
+#include <mutex>
+#include <numeric>
 #include <queue>
 #include <set>
+#include <sstream>
 #include <stack>
 #include <string>
+#include <tuple>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -45,150 +69,484 @@ inline void printPath(const std::vector<std::string> &path,
                       std::ostream &out = std::cout) {
   for (const std::string &node : path)
     out << node << " ";
-  out << std::endl;
+  out << "\n";
 }
 
 inline void printPathChar(const std::vector<char> &path,
                           std::ostream &out = std::cout) {
   for (char node : path)
     out << node << " ";
-  out << std::endl;
+  out << "\n";
 }
 
+inline void printPath(const CSRGraph &g, const std::vector<int> &path,
+                      std::ostream &out = std::cout) {
+  for (int node : path)
+    out << g.name(node) << " ";
+  out << "\n";
+}
+
+// Rebuilds the room sequence ending at `goal` by following parent links
+// back to a root (parent -1). Called once per search, at the goal.
+inline std::vector<int> tracePath(const std::vector<int> &parent, int goal) {
+  std::vector<int> path;
+  for (int u = goal; u != -1; u = parent[u])
+    path.push_back(u);
+  std::reverse(path.begin(), path.end());
+  return path;
+}
+
+struct SearchResult {
+  bool found = false;
+  std::vector<int> path;    // start .. goal (partial path for hill climbing)
+  long long expanded = 0;   // nodes taken off the frontier
+  long long generated = 0;  // nodes put on the frontier
+  size_t peakFrontier = 0;  // largest frontier held at once
+  long long reexpanded = 0; // expansions of a node already expanded before
+  long long cost = -1;      // sum of door costs along `path`; -1 where the
+                            // search does not add them up
+};
+
+// h(u) read from the graph's heuristic column. The heuristic searches
+// take h as a callable so that a caller can supply bounds for its own goal
+// (e.g. ALT landmarks) room by room, without building a column per query.
+struct ColumnHeuristic {
+  const CSRGraph &g;
+  int operator()(int u) const { return g.heuristic[u]; }
+};
+
 struct graph {
   std::unordered_map<char, std::vector<char>> adjlist;
   std::unordered_map<char, int> heuristic;
 };
 
+inline CSRGraph
+buildCSR(const std::map<std::string, std::vector<std::string>> &adj) {
+  CSRBuilder b;
+  for (const auto &[node, nbrs] : adj) {
+    b.intern(node);
+    for (const std::string &nbr : nbrs)
+      b.addEdge(node, nbr);
+  }
+  return b.build();
+}
+
+inline CSRGraph buildCSR(const graph &g) {
+  CSRBuilder b;
+  for (const auto &[node, nbrs] : g.adjlist) {
+    b.intern(std::string(1, node));
+    for (char nbr : nbrs)
+      b.addEdge(std::string(1, node), std::string(1, nbr));
+  }
+  for (const auto &[node, h] : g.heuristic)
+    b.setHeuristic(std::string(1, node), h);
+  return b.build();
+}
+
+inline SearchResult runBFS(const CSRGraph &g, int start, int goal,
+                           SearchWorkspace &ws) {
+  SearchResult r;
+  if (start < 0 || goal < 0)
+    return r;
+  // Nodes are marked when discovered, so each one enters the queue at most
+  // once and the queue never outgrows V.
+  ws.begin(g.size());
+  std::vector<int> &queue = ws.queue;
+  queue.push_back(start);
+  ws.see(start, -1);
+  r.generated = 1;
+  for (size_t head = 0; head < queue.size(); head++) {
+    r.peakFrontier = std::max(r.peakFrontier, queue.size() - head);
+    int curr = queue[head];
+    r.expanded++;
+    if (curr == goal) {
+      r.found = true;
+      r.path = ws.trace(goal);
+      return r;
+    }
+    for (int nbr : g.neighbors(curr)) {
+      if (!ws.seen(nbr)) {
+        ws.see(nbr, curr);
+        queue.push_back(nbr);
+        r.generated++;
+      }
+    }
+  }
+  return r;
+}
+
+inline SearchResult runBFS(const CSRGraph &g, int start, int goal) {
+  SearchWorkspace ws;
+  return runBFS(g, start, goal, ws);
+}
+
+inline SearchResult bfs(const CSRGraph &g, int src, int dest,
+                        bool reverse = false, std::ostream &out = std::cout) {
+  out << (reverse ? "Reverse BFS:\n" : "Forward BFS:\n");
+  SearchResult r = reverse ? runBFS(g, dest, src) : runBFS(g, src, dest);
+  if (!r.found) {
+    out << "No path found.\n";
+    return r;
+  }
+  out << "Path: ";
+  printPath(g, r.path, out);
+  out << "Nodes expanded: " << r.expanded << "\n";
+  out << "Time: O(V+E), Space: O(V)\n";
+  return r;
+}
+
 inline void bfs(const std::string &src, const std::string &dest,
                 const std::map<std::string, std::vector<std::string>> &adj,
                 bool reverse = false, std::ostream &out = std::cout) {
-  out << (reverse ? "Reverse BFS:\n" : "Forward BFS:\n");
-  std::string start = reverse ? dest : src;
-  std::string goal = reverse ? src : dest;
-  std::queue<std::vector<std::string>> q;
-  std::set<std::string> visited;
-  q.push({start});
-  int expanded = 0;
-  while (!q.empty()) {
-    auto path = q.front();
-    q.pop();
-    std::string curr = path.back();
-    expanded++;
+  CSRGraph g = buildCSR(adj);
+  bfs(g, g.id(src), g.id(dest), reverse, out);
+}
+
+// Switch points for directionOptimizingBFS (Beamer et al.): go bottom-up
+// once the frontier's edges exceed unexplored edges / alpha, and back
+// top-down once the frontier shrinks below V / beta.
+struct DOBFSParams {
+  int alpha = 14;
+  int beta = 24;
+};
+
+struct DOBFSResult : SearchResult {
+  int topDownLevels = 0;
+  int bottomUpLevels = 0;
+};
+
+// BFS that expands small frontiers top-down (push along out-edges) and
+// large ones bottom-up (each unvisited node looks for a parent in the
+// frontier through `incoming`, the transpose of `g`). Frontier and visited
+// sets are bitmaps; the path is still rebuilt from parent links.
+inline DOBFSResult runDirectionOptimizingBFS(const CSRGraph &g,
+                                             const CSRGraph &incoming,
+                                             int src, int dest,
+                                             DOBFSParams params = {}) {
+  DOBFSResult r;
+  if (src < 0 || dest < 0)
+    return r;
+  int n = g.size();
+  Bitmap visited(n), frontier(n), next(n);
+  std::vector<int> parent(n, -1);
+  std::vector<int> list, nextList;
+  list.reserve(n);
+  nextList.reserve(n);
+  visited.set(src);
+  frontier.set(src);
+  list.push_back(src);
+  r.generated = 1;
+  long long unexplored = g.edgeCount() - g.neighbors(src).size();
+  long long frontierEdges = g.neighbors(src).size();
+  bool bottomUp = false;
+  while (!list.empty() && !visited.test(dest)) {
+    if (!bottomUp && frontierEdges > unexplored / params.alpha)
+      bottomUp = true;
+    else if (bottomUp && (long long)list.size() < n / params.beta)
+      bottomUp = false;
+    r.expanded += list.size();
+    r.peakFrontier = std::max(r.peakFrontier, list.size());
+    nextList.clear();
+    next.clear();
+    if (bottomUp) {
+      r.bottomUpLevels++;
+      for (int v = 0; v < n; v++) {
+        if (visited.test(v))
+          continue;
+        for (int u : incoming.neighbors(v)) {
+          if (frontier.test(u)) {
+            parent[v] = u;
+            next.set(v);
+            nextList.push_back(v);
+            break;
+          }
+        }
+      }
+      for (int v : nextList)
+        visited.set(v);
+    } else {
+      r.topDownLevels++;
+      for (int u : list) {
+        for (int v : g.neighbors(u)) {
+          if (!visited.test(v)) {
+            visited.set(v);
+            parent[v] = u;
+            next.set(v);
+            nextList.push_back(v);
+          }
+        }
+      }
+    }
+    r.generated += nextList.size();
+    frontierEdges = 0;
+    for (int v : nextList)
+      frontierEdges += g.neighbors(v).size();
+    unexplored -= frontierEdges;
+    frontier.swap(next);
+    list.swap(nextList);
+  }
+  if (visited.test(dest)) {
+    r.found = true;
+    r.path = tracePath(parent, dest);
+  }
+  return r;
+}
+
+inline DOBFSResult directionOptimizingBFS(const CSRGraph &g,
+                                          const CSRGraph &incoming, int src,
+                                          int dest,
+                                          std::ostream &out = std::cout,
+                                          DOBFSParams params = DOBFSParams()) {
+  out << "Direction-optimizing BFS:\n";
+  DOBFSResult r = runDirectionOptimizingBFS(g, incoming, src, dest, params);
+  if (!r.found) {
+    out << "No path found.\n";
+    return r;
+  }
+  out << "Path: ";
+  printPath(g, r.path, out);
+  out << "Nodes expanded: " << r.expanded << "\n";
+  out << "Levels top-down: " << r.topDownLevels
+      << ", bottom-up: " << r.bottomUpLevels << "\n";
+  out << "Time: O(V+E), Space: O(V)\n";
+  return r;
+}
+
+inline DOBFSResult directionOptimizingBFS(const CSRGraph &g, int src, int dest,
+                                          std::ostream &out = std::cout,
+                                          DOBFSParams params = DOBFSParams()) {
+  return directionOptimizingBFS(g, transpose(g), src, dest, out, params);
+}
+
+inline SearchResult runDFS(const CSRGraph &g, int start, int goal,
+                           SearchWorkspace &ws) {
+  SearchResult r;
+  if (start < 0 || goal < 0)
+    return r;
+  // Stack entries are (node, node it was pushed from); a node's parent is
+  // fixed when it is first popped, which keeps the classic DFS order.
+  ws.begin(g.size());
+  std::vector<std::pair<int, int>> &stk = ws.stack;
+  stk.emplace_back(start, -1);
+  r.generated = 1;
+  while (!stk.empty()) {
+    r.peakFrontier = std::max(r.peakFrontier, stk.size());
+    auto [curr, from] = stk.back();
+    stk.pop_back();
+    r.expanded++;
     if (curr == goal) {
-      out << "Path: ";
-      printPath(path, out);
-      out << "Nodes expanded: " << expanded << std::endl;
-      out << "Time: O(V+E), Space: O(V)\n";
-      return;
+      ws.see(curr, from);
+      r.found = true;
+      r.path = ws.trace(goal);
+      return r;
     }
-    if (visited.count(curr))
+    if (ws.seen(curr))
       continue;
-    visited.insert(curr);
-    for (const std::string &nbr : adj.at(curr)) {
-      if (!visited.count(nbr)) {
-        auto newPath = path;
-        newPath.push_back(nbr);
-        q.push(newPath);
+    ws.see(curr, from);
+    for (int nbr : g.neighbors(curr)) {
+      if (!ws.seen(nbr)) {
+        stk.emplace_back(nbr, curr);
+        r.generated++;
       }
     }
   }
-  out << "No path found.\n";
+  return r;
+}
+
+inline SearchResult runDFS(const CSRGraph &g, int start, int goal) {
+  SearchWorkspace ws;
+  return runDFS(g, start, goal, ws);
+}
+
+inline SearchResult dfs(const CSRGraph &g, int src, int dest,
+                        bool reverse = false, std::ostream &out = std::cout) {
+  out << (reverse ? "Reverse DFS:\n" : "Forward DFS:\n");
+  SearchResult r = reverse ? runDFS(g, dest, src) : runDFS(g, src, dest);
+  if (!r.found) {
+    out << "No path found.\n";
+    return r;
+  }
+  out << "Path: ";
+  printPath(g, r.path, out);
+  out << "Nodes expanded: " << r.expanded << "\n";
+  out << "Time: O(V+E), Space: O(V)\n";
+  return r;
 }
 
 inline void dfs(const std::string &src, const std::string &dest,
                 const std::map<std::string, std::vector<std::string>> &adj,
                 bool reverse = false, std::ostream &out = std::cout) {
-  out << (reverse ? "Reverse DFS:\n" : "Forward DFS:\n");
-  std::string start = reverse ? dest : src;
-  std::string goal = reverse ? src : dest;
-  std::stack<std::vector<std::string>> stk;
-  std::set<std::string> visited;
-  stk.push({start});
-  int expanded = 0;
-  while (!stk.empty()) {
-    auto path = stk.top();
-    stk.pop();
-    std::string curr = path.back();
-    expanded++;
-    if (curr == goal) {
-      out << "Path: ";
-      printPath(path, out);
-      out << "Nodes expanded: " << expanded << std::endl;
-      out << "Time: O(V+E), Space: O(V)\n";
-      return;
-    }
-    if (visited.count(curr))
-      continue;
-    visited.insert(curr);
-    for (const std::string &nbr : adj.at(curr)) {
-      if (!visited.count(nbr)) {
-        auto newPath = path;
-        newPath.push_back(nbr);
-        stk.push(newPath);
+  CSRGraph g = buildCSR(adj);
+  dfs(g, g.id(src), g.id(dest), reverse, out);
+}
+
+// Side 0 of the workspace searches from src, side 1 from dest.
+inline SearchResult runBiBFS(const CSRGraph &g, int src, int dest,
+                             SearchWorkspace &ws) {
+  SearchResult r;
+  if (src < 0 || dest < 0)
+    return r;
+  ws.begin(g.size());
+  std::vector<int> &q1 = ws.queue, &q2 = ws.queue2;
+  size_t head1 = 0, head2 = 0;
+  q1.push_back(src);
+  ws.see(src, -1, 0);
+  q2.push_back(dest);
+  ws.see(dest, -1, 1);
+  r.generated = 2;
+  // Expands one full level of one side; returns the meeting node or -1.
+  auto expand = [&](std::vector<int> &q, size_t &head, int side) -> int {
+    size_t levelEnd = q.size();
+    for (; head < levelEnd; head++) {
+      int curr = q[head];
+      r.expanded++;
+      if (ws.seen(curr, 1 - side))
+        return curr;
+      for (int nbr : g.neighbors(curr)) {
+        if (!ws.seen(nbr, side)) {
+          ws.see(nbr, curr, side);
+          q.push_back(nbr);
+          r.generated++;
+        }
       }
     }
+    return -1;
+  };
+  while (head1 < q1.size() && head2 < q2.size()) {
+    r.peakFrontier =
+        std::max(r.peakFrontier, (q1.size() - head1) + (q2.size() - head2));
+    int meet = expand(q1, head1, 0);
+    if (meet == -1)
+      meet = expand(q2, head2, 1);
+    if (meet != -1) {
+      r.found = true;
+      r.path = ws.trace(meet, 0);
+      for (int u = ws.parentOf(meet, 1); u != -1; u = ws.parentOf(u, 1))
+        r.path.push_back(u);
+      return r;
+    }
+  }
+  return r;
+}
+
+inline SearchResult runBiBFS(const CSRGraph &g, int src, int dest) {
+  SearchWorkspace ws;
+  return runBiBFS(g, src, dest, ws);
+}
+
+inline SearchResult biBFS(const CSRGraph &g, int src, int dest,
+                          std::ostream &out = std::cout) {
+  out << "Bidirectional BFS:\n";
+  SearchResult r = runBiBFS(g, src, dest);
+  if (!r.found) {
+    out << "No path found.\n";
+    return r;
   }
-  out << "No path found.\n";
+  out << "Path: ";
+  printPath(g, r.path, out);
+  out << "Nodes expanded: " << r.expanded << "\n";
+  out << "Time: O(b^(d/2)), Space: O(b^(d/2))\n";
+  return r;
 }
 
 inline void biBFS(const std::string &src, const std::string &dest,
                   const std::map<std::string, std::vector<std::string>> &adj,
                   std::ostream &out = std::cout) {
-  out << "Bidirectional BFS:\n";
-  std::queue<std::vector<std::string>> q1, q2;
-  std::map<std::string, std::vector<std::string>> paths1, paths2;
-  std::set<std::string> visited1, visited2;
-  q1.push({src});
-  paths1[src] = {src};
-  visited1.insert(src);
-  q2.push({dest});
-  paths2[dest] = {dest};
-  visited2.insert(dest);
-  int expanded = 0;
-  while (!q1.empty() && !q2.empty()) {
-    auto expand =
-        [&](std::queue<std::vector<std::string>> &q,
-            std::set<std::string> &visitedThis,
-            std::set<std::string> &visitedOther,
-            std::map<std::string, std::vector<std::string>> &pathsThis,
-            std::map<std::string, std::vector<std::string>> &pathsOther)
-        -> bool {
-      int sz = q.size();
-      while (sz--) {
-        auto path = q.front();
-        q.pop();
-        std::string curr = path.back();
-        expanded++;
-        if (visitedOther.count(curr)) {
-          auto otherPath = pathsOther[curr];
-          if (&pathsThis == &paths1)
-            std::reverse(otherPath.begin(), otherPath.end());
-          path.insert(path.end(), otherPath.begin() + 1, otherPath.end());
-          out << "Path: ";
-          printPath(path, out);
-          out << "Nodes expanded: " << expanded << std::endl;
-          out << "Time: O(b^(d/2)), Space: O(b^(d/2))\n";
-          return true;
-        }
-        for (const std::string &nbr : adj.at(curr)) {
-          if (!visitedThis.count(nbr)) {
-            visitedThis.insert(nbr);
-            auto newPath = path;
-            newPath.push_back(nbr);
-            pathsThis[nbr] = newPath;
-            q.push(newPath);
-          }
-        }
-      }
-      return false;
-    };
-    if (expand(q1, visited1, visited2, paths1, paths2))
-      return;
-    if (expand(q2, visited2, visited1, paths2, paths1))
+  CSRGraph g = buildCSR(adj);
+  biBFS(g, g.id(src), g.id(dest), out);
+}
+
+// Receives each simple path as it is found; the vector is only valid for
+// the duration of the call.
+using PathCallback = std::function<void(const std::vector<int> &)>;
+
+struct BritishMuseumResult : SearchResult {
+  long long paths = 0; // simple paths from start to goal
+};
+
+// One open room on the current path and the next door to try out of it.
+struct SimplePathFrame {
+  int node, next;
+};
+
+// Walks every simple path that starts with `path` (whose rooms are set in
+// `onPath`) followed by `root`, with an explicit stack instead of
+// recursion. `split(frames)` runs before each step and may claim the
+// untried doors of any frame by advancing its `next`. On return `path` and
+// `onPath` are as they were on entry. An empty `found` only counts paths.
+template <class Split>
+inline void walkSimplePaths(const CSRGraph &g, int root, int goal,
+                            std::vector<int> &path, Bitmap &onPath,
+                            const PathCallback &found, BritishMuseumResult &r,
+                            Split &&split) {
+  std::vector<SimplePathFrame> frames;
+  auto enter = [&](int node) {
+    path.push_back(node);
+    r.expanded++;
+    r.peakFrontier = std::max(r.peakFrontier, path.size());
+    if (node != goal) {
+      onPath.set(node);
+      frames.push_back({node, g.offsets[node]});
       return;
+    }
+    if (!r.found)
+      r.path = path;
+    r.found = true;
+    r.paths++;
+    if (found)
+      found(path);
+    path.pop_back();
+  };
+  enter(root);
+  while (!frames.empty()) {
+    split(frames);
+    SimplePathFrame &f = frames.back();
+    if (f.next == g.offsets[f.node + 1]) {
+      onPath.reset(f.node);
+      path.pop_back();
+      frames.pop_back();
+      continue;
+    }
+    int v = g.targets[f.next++];
+    if (!onPath.test(v)) {
+      r.generated++;
+      enter(v);
+    }
+  }
+}
+
+// Enumerates every simple path from start to goal, handing each one to
+// `onPath` as it is found (pass nullptr to only count them). `path` is the
+// first one; `expanded` counts rooms entered. Memory is O(V) whatever the
+// number of paths.
+inline BritishMuseumResult runBritishMuseum(const CSRGraph &g, int start,
+                                            int goal,
+                                            const PathCallback &onPath) {
+  BritishMuseumResult r;
+  if (start < 0 || goal < 0)
+    return r;
+  std::vector<int> path;
+  Bitmap visited(g.size());
+  r.generated = 1;
+  walkSimplePaths(g, start, goal, path, visited, onPath, r,
+                  [](std::vector<SimplePathFrame> &) {});
+  return r;
+}
+
+inline BritishMuseumResult britishMuseum(const CSRGraph &g, int src, int dest,
+                                         bool reverse = false,
+                                         std::ostream &out = std::cout) {
+  out << (reverse ? "Reverse BMS:\n" : "Forward BMS:\n");
+  auto print = [&](const std::vector<int> &p) { printPath(g, p, out); };
+  BritishMuseumResult r = reverse ? runBritishMuseum(g, dest, src, print)
+                                  : runBritishMuseum(g, src, dest, print);
+  if (r.paths == 0) {
+    out << "No path found.\n";
+    return r;
   }
-  out << "No path found.\n";
+  out << "Paths found: " << r.paths << "\n";
+  out << "Time: O(b^d), Space: O(b^d)\n";
+  return r;
 }
 
 inline void
@@ -196,152 +554,1066 @@ britishMuseum(const std::string &src,
               const std::map<std::string, std::vector<std::string>> &adj,
               std::string dest, bool reverse = false,
               std::ostream &out = std::cout) {
-  out << (reverse ? "Reverse BMS:\n" : "Forward BMS:\n");
-  std::string start = reverse ? dest : src;
-  std::string goal = reverse ? src : dest;
-  std::vector<std::string> path;
-  std::set<std::string> visited;
-  std::vector<std::vector<std::string>> allPaths;
-  std::function<void(std::string)> dfs = [&](std::string node) {
-    visited.insert(node);
-    path.push_back(node);
-    if (node == goal) {
-      allPaths.push_back(path);
-    } else {
-      for (const std::string &nbr : adj.at(node)) {
-        if (!visited.count(nbr)) {
-          dfs(nbr);
-        }
+  CSRGraph g = buildCSR(adj);
+  britishMuseum(g, g.id(src), g.id(dest), reverse, out);
+}
+
+// --- Heuristic algorithms (corrected) ---
+
+// Greedy descent on the heuristic. On a local optimum `found` is false and
+// `path` holds the rooms visited so far. With `trace`, every neighbor
+// considered is written as "<neighbor><current>.". `h(u)` gives the
+// heuristic of room u.
+template <class Heuristic>
+inline SearchResult runHillClimbing(const CSRGraph &g, int start, int goal,
+                                    std::ostream *trace, Heuristic &&h) {
+  SearchResult r;
+  if (start < 0)
+    return r;
+  int current = start;
+  r.path.push_back(current);
+  r.generated = 1;
+  r.peakFrontier = 1;
+
+  while (current != goal) {
+    int best_neighbor = -1;          // no neighbor chosen yet
+    int best_heuristic = h(current); // current node's heuristic
+    r.expanded++;
+
+    for (int neighbor : g.neighbors(current)) {
+      if (trace)
+        *trace << g.name(neighbor) << g.name(current) << ".\n";
+      r.generated++;
+      if (h(neighbor) < best_heuristic) {
+        best_heuristic = h(neighbor);
+        best_neighbor = neighbor;
       }
     }
-    path.pop_back();
-    visited.erase(node);
-  };
-  dfs(start);
-  if (allPaths.empty()) {
-    out << "No path found.\n";
-    return;
+    if (best_neighbor == -1)
+      return r;
+    current = best_neighbor;
+    r.path.push_back(current);
   }
-  for (const auto &p : allPaths) {
-    printPath(p, out);
+  r.expanded++;
+  r.found = true;
+  return r;
+}
+
+inline SearchResult runHillClimbing(const CSRGraph &g, int start, int goal,
+                                    std::ostream *trace = nullptr) {
+  return runHillClimbing(g, start, goal, trace, ColumnHeuristic{g});
+}
+
+// Prints the climb; `trace` also lists every neighbor considered.
+inline SearchResult hillclimbing(const CSRGraph &g, int start, int goal,
+                                 std::ostream &out = std::cout,
+                                 bool trace = false) {
+  if (start < 0) {
+    out << "No path found.\n";
+    return SearchResult();
   }
-  out << "Paths found: " << allPaths.size() << std::endl;
-  out << "Time: O(b^d), Space: O(b^d)\n";
+  SearchResult r = runHillClimbing(g, start, goal, trace ? &out : nullptr);
+  if (!r.found)
+    out << "Stuck at local optimum. No path found.\n";
+  out << "Path: ";
+  printPath(g, r.path, out);
+  return r;
 }
 
-// --- Heuristic algorithms (corrected) ---
+/*
+    Hill-climbing engine. Every mode descends the heuristic from `start`
+   and succeeds when it steps onto `goal`.
 
-inline void hillclimbing(char start, char goal, graph &g,
-                         std::ostream &out = std::cout) {
-  char current = start;
-  std::vector<char> path;
-  path.push_back(current);
+    - kSteepest:      runHillClimbing, one deterministic climb.
+    - kFirstChoice:   neighbors are tried in random order and the first
+   lower one is taken.
+    - kRandomRestart: steepest descent, each attempt after the first from
+   the end of a short random walk out of `start`.
+    - kAnnealing:     a random neighbor is taken if it is lower, or with
+   probability exp(-rise / T) otherwise; T cools after every move.
 
-  while (current != goal) {
-    char best_neighbor = '\0';                 // no neighbor chosen yet
-    int best_heuristic = g.heuristic[current]; // current node's heuristic
+    The stochastic modes make `attempts` independent climbs, each with its
+   own SplitMix64 stream, so attempt i behaves the same on any thread. With a
+   pool the attempts run concurrently and the first to reach the goal stops
+   the others; without one they run in order, which makes the result
+   repeatable. Walks may revisit rooms; the reported path has its loops
+   erased.
+*/
+enum class HillClimbMode {
+  kSteepest,
+  kFirstChoice,
+  kRandomRestart,
+  kAnnealing
+};
 
-    for (char neighbor : g.adjlist[current]) {
-      out << neighbor << current << ".\n"; // debug: neighbor and current
-      if (g.heuristic[neighbor] < best_heuristic) {
-        best_heuristic = g.heuristic[neighbor];
-        best_neighbor = neighbor;
+struct HillClimbOptions {
+  HillClimbMode mode = HillClimbMode::kRandomRestart;
+  int attempts = 64;             // climbs tried; kSteepest makes one
+  int maxSteps = 0;              // moves per climb, 0 for 4 * rooms
+  int maxKick = 16;              // kRandomRestart: longest random walk
+  double temperature = 4;        // kAnnealing: starting temperature
+  double cooling = 0.99;         // kAnnealing: T *= cooling per move
+  uint64_t seed = 1;
+  std::ostream *trace = nullptr; // every move, as "attempt: from -> to"
+};
+
+struct HillClimbResult : SearchResult {
+  int attempts = 0; // climbs started
+  int winner = -1;  // attempt that reached the goal
+};
+
+// Small, fast PRNG; independent streams come from different seeds.
+struct SplitMix64 {
+  uint64_t state;
+
+  explicit SplitMix64(uint64_t seed) : state(seed) {}
+
+  uint64_t next() {
+    uint64_t z = state += 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+  }
+  int below(int n) { return int(next() % uint64_t(n)); }
+  double unit() { return double(next() >> 11) * 0x1.0p-53; }
+};
+
+// Drops every loop from a walk over rooms 0 .. n-1, leaving a simple path
+// between its ends.
+inline std::vector<int> eraseLoops(const std::vector<int> &walk, int n) {
+  std::vector<int> path, at(n, -1);
+  for (int u : walk) {
+    if (at[u] == -1) {
+      at[u] = int(path.size());
+      path.push_back(u);
+      continue;
+    }
+    for (size_t i = at[u] + 1; i < path.size(); i++)
+      at[path[i]] = -1;
+    path.resize(at[u] + 1);
+  }
+  return path;
+}
+
+// One stochastic climb; appends the rooms it walks through to `walk`.
+// Returns true on reaching the goal, false when stuck, out of steps or
+// told to `stop`.
+inline bool climbOnce(const CSRGraph &g, int start, int goal,
+                      const HillClimbOptions &opts, int attempt,
+                      const std::atomic<bool> &stop, std::vector<int> &walk,
+                      HillClimbResult &r, std::mutex &traceMtx) {
+  SplitMix64 rng(opts.seed * 0x2545f4914f6cdd1dULL + uint64_t(attempt));
+  int maxSteps = opts.maxSteps > 0 ? opts.maxSteps : 4 * g.size();
+  int current = start;
+  int kick = opts.mode == HillClimbMode::kRandomRestart && attempt > 0
+                 ? 1 + rng.below(std::max(1, opts.maxKick))
+                 : 0;
+  double temperature = opts.temperature;
+  walk.push_back(start);
+  for (int step = 0; step < maxSteps && current != goal; step++) {
+    if (stop.load(std::memory_order_relaxed))
+      return false;
+    int first = g.offsets[current], degree = g.offsets[current + 1] - first;
+    if (degree == 0)
+      return false;
+    r.expanded++;
+    int next = -1;
+    if (step < kick) {
+      next = g.targets[first + rng.below(degree)];
+      r.generated++;
+    } else if (opts.mode == HillClimbMode::kAnnealing) {
+      next = g.targets[first + rng.below(degree)];
+      r.generated++;
+      int rise = g.heuristic[next] - g.heuristic[current];
+      if (rise > 0 && rng.unit() >= std::exp(-rise / temperature))
+        next = -1;
+      temperature = std::max(temperature * opts.cooling, 1e-9);
+    } else if (opts.mode == HillClimbMode::kFirstChoice) {
+      int offset = rng.below(degree);
+      for (int i = 0; i < degree && next == -1; i++) {
+        int v = g.targets[first + (offset + i) % degree];
+        r.generated++;
+        if (g.heuristic[v] < g.heuristic[current])
+          next = v;
+      }
+      if (next == -1)
+        return false;
+    } else {
+      int best = g.heuristic[current];
+      for (int v : g.neighbors(current)) {
+        r.generated++;
+        if (g.heuristic[v] < best) {
+          best = g.heuristic[v];
+          next = v;
+        }
       }
+      if (next == -1)
+        return false;
     }
-    if (best_neighbor == '\0') {
-      out << "Stuck at local optimum. No path found.\n";
-      out << "Path: ";
-      printPathChar(path, out);
-      return;
+    if (next == -1)
+      continue;
+    if (opts.trace) {
+      std::lock_guard<std::mutex> lock(traceMtx);
+      *opts.trace << attempt << ": " << g.name(current) << " -> "
+                  << g.name(next) << "\n";
     }
-    current = best_neighbor;
-    path.push_back(current);
+    current = next;
+    walk.push_back(current);
+  }
+  return current == goal;
+}
+
+inline HillClimbResult runHillClimbEngine(const CSRGraph &g, int start,
+                                          int goal,
+                                          const HillClimbOptions &opts,
+                                          ThreadPool *pool = nullptr) {
+  HillClimbResult r;
+  if (start < 0 || goal < 0)
+    return r;
+  if (opts.mode == HillClimbMode::kSteepest) {
+    static_cast<SearchResult &>(r) =
+        runHillClimbing(g, start, goal, opts.trace);
+    r.attempts = 1;
+    r.winner = r.found ? 0 : -1;
+    return r;
+  }
+  int attempts = std::max(1, opts.attempts);
+  std::atomic<int> nextAttempt{0};
+  std::atomic<bool> solved{false};
+  std::mutex mtx, traceMtx; // mtx guards r
+  int stuckAt = std::numeric_limits<int>::max(); // best failed end room's h
+  auto worker = [&](int) {
+    HillClimbResult mine;
+    std::vector<int> walk;
+    int a;
+    while (!solved.load(std::memory_order_relaxed) &&
+           (a = nextAttempt++) < attempts) {
+      walk.clear();
+      bool ok = climbOnce(g, start, goal, opts, a, solved, walk, mine,
+                          traceMtx);
+      std::lock_guard<std::mutex> lock(mtx);
+      r.attempts++;
+      if (ok && !r.found) {
+        r.found = true;
+        r.winner = a;
+        r.path = eraseLoops(walk, g.size());
+        solved = true;
+      } else if (!ok && !r.found && g.heuristic[walk.back()] < stuckAt) {
+        // Keep the failed climb that got lowest, as runHillClimbing does.
+        stuckAt = g.heuristic[walk.back()];
+        r.path = eraseLoops(walk, g.size());
+      }
+    }
+    std::lock_guard<std::mutex> lock(mtx);
+    r.expanded += mine.expanded;
+    r.generated += mine.generated;
+  };
+  if (pool && pool->size() > 1)
+    pool->parallelFor(pool->size(), worker);
+  else
+    worker(0);
+  r.generated++; // the start room
+  r.peakFrontier = 1;
+  return r;
+}
+
+inline const char *hillClimbModeName(HillClimbMode mode) {
+  switch (mode) {
+  case HillClimbMode::kSteepest:
+    return "steepest ascent";
+  case HillClimbMode::kFirstChoice:
+    return "first choice";
+  case HillClimbMode::kRandomRestart:
+    return "random restart";
+  case HillClimbMode::kAnnealing:
+    return "simulated annealing";
+  }
+  return "";
+}
+
+inline HillClimbResult hillClimbEngine(const CSRGraph &g, int start, int goal,
+                                       const HillClimbOptions &opts,
+                                       ThreadPool *pool = nullptr,
+                                       std::ostream &out = std::cout) {
+  HillClimbResult r = runHillClimbEngine(g, start, goal, opts, pool);
+  out << "Mode: " << hillClimbModeName(opts.mode) << "\n";
+  if (r.path.empty()) {
+    out << "No path found.\n";
+    return r;
   }
+  if (!r.found)
+    out << "Stuck at local optimum after " << r.attempts
+        << " attempts. No path found.\n";
   out << "Path: ";
-  printPathChar(path, out);
+  printPath(g, r.path, out);
+  if (r.found)
+    out << "Attempts: " << r.attempts << " (attempt " << r.winner
+        << " reached the goal)\n";
+  return r;
 }
+
+inline void hillclimbing(char start, char goal, graph &g,
+                         std::ostream &out = std::cout) {
+  CSRGraph h = buildCSR(g);
+  hillclimbing(h, h.id(std::string(1, start)), h.id(std::string(1, goal)),
+               out);
+}
+
+// One beam entry; `parent` indexes the entry it was expanded from in the
+// per-search arena, so beam members share their common path prefix.
 struct NodePath {
-  char node;
+  int node;
   int heuristic_val;
-  std::vector<char> path;
-  NodePath() : node(0), heuristic_val(0), path() {} // default constructor
-  NodePath(char n, int h, std::vector<char> p)
-      : node(n), heuristic_val(h), path(std::move(p)) {}
+  int parent;
+  NodePath() : node(0), heuristic_val(0), parent(-1) {} // default constructor
+  NodePath(int n, int h, int p) : node(n), heuristic_val(h), parent(p) {}
 };
 
+// Beam entries live in one arena per search and keep only a parent link,
+// so entries share the path prefix they have in common and a level costs
+// `beamwidth` entries however long the paths get.
+
+// Expands entries [first, last) of `level` into `children`: one child per
+// door to a room not already on the entry's path. The path is stamped into
+// `mark` once per entry, so each door is checked in O(1).
+template <class Heuristic>
+inline void expandBeam(const CSRGraph &g, const std::vector<NodePath> &arena,
+                       const std::vector<int> &level, size_t first,
+                       size_t last, std::vector<uint32_t> &mark,
+                       uint32_t &epoch, std::vector<NodePath> &children,
+                       Heuristic &&h) {
+  for (size_t i = first; i < last; i++) {
+    int e = level[i];
+    if (++epoch == 0) {
+      std::fill(mark.begin(), mark.end(), 0);
+      epoch = 1;
+    }
+    for (int a = e; a != -1; a = arena[a].parent)
+      mark[arena[a].node] = epoch;
+    for (int v : g.neighbors(arena[e].node))
+      if (mark[v] != epoch)
+        children.emplace_back(v, h(v), e);
+  }
+}
+
+// Moves the `beamwidth` children with the lowest heuristic (ties to the
+// earlier child) into the arena, best first, and makes them the new level.
+// A negative width keeps every child. nth_element keeps this O(children)
+// instead of sorting the whole level.
+inline void selectBeam(const std::vector<NodePath> &children, int beamwidth,
+                       std::vector<NodePath> &arena, std::vector<int> &level,
+                       std::vector<int> &order) {
+  order.resize(children.size());
+  std::iota(order.begin(), order.end(), 0);
+  auto better = [&](int a, int b) {
+    return children[a].heuristic_val != children[b].heuristic_val
+               ? children[a].heuristic_val < children[b].heuristic_val
+               : a < b;
+  };
+  if (beamwidth >= 0 && order.size() > size_t(beamwidth)) {
+    std::nth_element(order.begin(), order.begin() + beamwidth, order.end(),
+                     better);
+    order.resize(beamwidth);
+  }
+  std::sort(order.begin(), order.end(), better);
+  level.clear();
+  for (int c : order) {
+    level.push_back(int(arena.size()));
+    arena.push_back(children[c]);
+  }
+}
+
+// Index of the first entry of `level` at `goal`, or -1.
+inline int beamGoal(const std::vector<NodePath> &arena,
+                    const std::vector<int> &level, int goal) {
+  for (size_t i = 0; i < level.size(); i++)
+    if (arena[level[i]].node == goal)
+      return int(i);
+  return -1;
+}
+
+inline std::vector<int> traceBeam(const std::vector<NodePath> &arena, int e) {
+  std::vector<int> path;
+  for (; e != -1; e = arena[e].parent)
+    path.push_back(arena[e].node);
+  std::reverse(path.begin(), path.end());
+  return path;
+}
+
+template <class Heuristic>
+inline SearchResult runBeamSearch(const CSRGraph &g, int start, int goal,
+                                  int beamwidth, Heuristic &&h) {
+  SearchResult r;
+  if (start < 0 || goal < 0)
+    return r;
+  std::vector<NodePath> arena, children;
+  std::vector<int> level, order;
+  std::vector<uint32_t> mark(g.size(), 0);
+  uint32_t epoch = 0;
+  arena.emplace_back(start, h(start), -1);
+  level.push_back(0);
+  r.generated = 1;
+  while (!level.empty()) {
+    int hit = beamGoal(arena, level, goal);
+    if (hit != -1) {
+      r.expanded += hit + 1;
+      r.path = traceBeam(arena, level[hit]);
+      r.found = true;
+      return r;
+    }
+    r.expanded += level.size();
+    children.clear();
+    expandBeam(g, arena, level, 0, level.size(), mark, epoch, children, h);
+    r.generated += children.size();
+    r.peakFrontier = std::max(r.peakFrontier, children.size());
+    selectBeam(children, beamwidth, arena, level, order);
+  }
+  return r;
+}
+
+inline SearchResult runBeamSearch(const CSRGraph &g, int start, int goal,
+                                  int beamwidth) {
+  return runBeamSearch(g, start, goal, beamwidth, ColumnHeuristic{g});
+}
+
+inline SearchResult beamsearch(const CSRGraph &g, int start, int goal,
+                               int beamwidth, std::ostream &out = std::cout) {
+  SearchResult r = runBeamSearch(g, start, goal, beamwidth);
+  if (!r.found) {
+    out << "No path found\n";
+    return r;
+  }
+  out << "Path: ";
+  printPath(g, r.path, out);
+  return r;
+}
+
 inline void beamsearch(char start, char goal, graph &g, int beamwidth,
                        std::ostream &out = std::cout) {
-  std::vector<NodePath> current_level;
-  current_level.emplace_back(start, g.heuristic[start],
-                             std::vector<char>{start});
-  while (!current_level.empty()) {
-    std::vector<NodePath> next_level;
-    for (auto &np : current_level) {
-      if (np.node == goal) {
-        out << "Path: ";
-        printPathChar(np.path, out);
-        return;
-      }
-      for (char neighbor : g.adjlist[np.node]) {
-        if (std::find(np.path.begin(), np.path.end(), neighbor) ==
-            np.path.end()) {
-          std::vector<char> new_path = np.path;
-          new_path.push_back(neighbor);
-          next_level.emplace_back(neighbor, g.heuristic[neighbor], new_path);
-        }
+  CSRGraph h = buildCSR(g);
+  beamsearch(h, h.id(std::string(1, start)), h.id(std::string(1, goal)),
+             beamwidth, out);
+}
+
+// `h(u)` gives the heuristic of room u.
+template <class Heuristic>
+inline SearchResult runBestFirstSearch(const CSRGraph &g, int start,
+                                       int goal, SearchWorkspace &ws,
+                                       Heuristic &&h) {
+  SearchResult r;
+  if (start < 0 || goal < 0)
+    return r;
+  // A min-heap on the heuristic, kept with the same heap operations as
+  // std::priority_queue so ties pop in the same order.
+  auto later = [](const BestFirstEntry &a, const BestFirstEntry &b) {
+    return a.heuristic > b.heuristic;
+  };
+  ws.begin(g.size());
+  std::vector<BestFirstEntry> &pq = ws.frontier;
+  auto push = [&](int node, int parent) {
+    pq.push_back({node, h(node), parent});
+    std::push_heap(pq.begin(), pq.end(), later);
+  };
+  push(start, -1);
+  r.generated = 1;
+
+  while (!pq.empty()) {
+    r.peakFrontier = std::max(r.peakFrontier, pq.size());
+    std::pop_heap(pq.begin(), pq.end(), later);
+    BestFirstEntry current = pq.back();
+    pq.pop_back();
+    if (ws.seen(current.node))
+      continue;
+    ws.see(current.node, current.parent);
+    r.expanded++;
+
+    if (current.node == goal) {
+      r.found = true;
+      r.path = ws.trace(goal);
+      return r;
+    }
+
+    // Every node on the current path is already closed, so the closed set
+    // alone rules out cycles.
+    for (int neighbor : g.neighbors(current.node)) {
+      if (!ws.seen(neighbor)) {
+        push(neighbor, current.node);
+        r.generated++;
       }
     }
-    std::sort(next_level.begin(), next_level.end(),
-              [](const NodePath &a, const NodePath &b) {
-                return a.heuristic_val < b.heuristic_val;
-              });
-    if (next_level.size() > (size_t)beamwidth)
-      next_level.resize(beamwidth);
-    current_level = std::move(next_level);
   }
-  out << "No path found\n";
+  return r;
+}
+
+inline SearchResult runBestFirstSearch(const CSRGraph &g, int start,
+                                       int goal, SearchWorkspace &ws) {
+  return runBestFirstSearch(g, start, goal, ws, ColumnHeuristic{g});
+}
+
+inline SearchResult runBestFirstSearch(const CSRGraph &g, int start,
+                                       int goal) {
+  SearchWorkspace ws;
+  return runBestFirstSearch(g, start, goal, ws);
+}
+
+inline SearchResult bestFirstSearch(const CSRGraph &g, int start, int goal,
+                                    std::ostream &out = std::cout) {
+  SearchResult r = runBestFirstSearch(g, start, goal);
+  if (!r.found) {
+    out << "No path found\n";
+    return r;
+  }
+  out << "Path: ";
+  printPath(g, r.path, out);
+  return r;
 }
 
 inline void bestFirstSearch(char start, char goal, graph &g,
                             std::ostream &out = std::cout) {
-  struct PQNode {
-    char node;
-    int heuristic_val;
-    std::vector<char> path;
-    PQNode(char n, int h, std::vector<char> p)
-        : node(n), heuristic_val(h), path(std::move(p)) {}
-    bool operator>(const PQNode &other) const {
-      return heuristic_val > other.heuristic_val;
+  CSRGraph h = buildCSR(g);
+  bestFirstSearch(h, h.id(std::string(1, start)), h.id(std::string(1, goal)),
+                  out);
+}
+
+// A* on door costs with h(n) from `h`. The open list is an indexed
+// heap keyed on (f, -g), so a node is queued at most once and ties prefer
+// the deeper node. With a consistent heuristic nothing is expanded twice;
+// otherwise closed nodes whose cost improves are reopened and counted in
+// `reexpanded`.
+// Side 1 of the workspace is the closed set. `h(u)` gives the heuristic of
+// room u; the overloads without it read g.heuristic.
+template <class Heuristic>
+inline SearchResult runAStar(const CSRGraph &g, int start, int goal,
+                             SearchWorkspace &ws, Heuristic &&h) {
+  SearchResult r;
+  if (start < 0 || goal < 0)
+    return r;
+  ws.begin(g.size());
+  std::vector<long long> &best = ws.best;
+  IndexedHeap<std::pair<long long, long long>> &open = ws.open;
+  ws.see(start, -1);
+  best[start] = 0;
+  open.push(start, {h(start), 0});
+  r.generated = 1;
+
+  while (!open.empty()) {
+    r.peakFrontier = std::max(r.peakFrontier, open.size());
+    int u = open.pop();
+    r.expanded++;
+    if (ws.seen(u, 1))
+      r.reexpanded++;
+    ws.see(u, -1, 1);
+    if (u == goal) {
+      r.found = true;
+      r.cost = best[u];
+      r.path = ws.trace(goal);
+      return r;
     }
+    for (int e = g.offsets[u]; e < g.offsets[u + 1]; e++) {
+      int v = g.targets[e];
+      long long cand = best[u] + g.cost(e);
+      if (ws.seen(v) && cand >= best[v])
+        continue;
+      ws.see(v, u);
+      best[v] = cand;
+      open.pushOrDecrease(v, {cand + h(v), -cand});
+      r.generated++;
+    }
+  }
+  return r;
+}
+
+inline SearchResult runAStar(const CSRGraph &g, int start, int goal,
+                             SearchWorkspace &ws) {
+  return runAStar(g, start, goal, ws, ColumnHeuristic{g});
+}
+
+inline SearchResult runAStar(const CSRGraph &g, int start, int goal) {
+  SearchWorkspace ws;
+  return runAStar(g, start, goal, ws);
+}
+
+inline SearchResult aStar(const CSRGraph &g, int start, int goal,
+                          std::ostream &out = std::cout) {
+  SearchResult r = runAStar(g, start, goal);
+  if (!r.found) {
+    out << "No path found\n";
+    return r;
+  }
+  out << "Path: ";
+  printPath(g, r.path, out);
+  out << "Path cost: " << r.cost << "\n";
+  out << "Nodes expanded: " << r.expanded << ", re-expanded: " << r.reexpanded
+      << "\n";
+  return r;
+}
+
+struct IDAStarResult : SearchResult {
+  int iterations = 0;
+};
+
+// Iterative-deepening A*: depth-first probes bounded by f = g + h, raising
+// the bound to the smallest f that exceeded it. Only the current path is
+// stored (an explicit stack, so deep maps cannot overflow the call stack),
+// plus two bits per room: one marks the current path, one records rooms
+// expanded in earlier probes so repeats are counted in `reexpanded`.
+inline IDAStarResult runIDAStar(const CSRGraph &g, int start, int goal) {
+  IDAStarResult r;
+  if (start < 0 || goal < 0)
+    return r;
+  struct Frame {
+    int node;
+    int edge; // next door of `node` to try
+    long long cost;
   };
+  const long long kInf = std::numeric_limits<long long>::max();
+  Bitmap onPath(g.size()), seen(g.size());
+  std::vector<Frame> stack;
+  long long bound = g.heuristic[start];
+  while (bound != kInf) {
+    r.iterations++;
+    long long nextBound = kInf;
+    stack.clear();
+    stack.push_back({start, g.offsets[start], 0});
+    onPath.set(start);
+    r.generated++;
+    bool firstVisit = true;
+    while (!stack.empty()) {
+      Frame &f = stack.back();
+      if (firstVisit) {
+        firstVisit = false;
+        if (f.node == goal) {
+          r.found = true;
+          r.cost = f.cost;
+          for (const Frame &p : stack)
+            r.path.push_back(p.node);
+          return r;
+        }
+        r.expanded++;
+        if (seen.test(f.node))
+          r.reexpanded++;
+        seen.set(f.node);
+        r.peakFrontier = std::max(r.peakFrontier, stack.size());
+      }
+      if (f.edge == g.offsets[f.node + 1]) {
+        onPath.reset(f.node);
+        stack.pop_back();
+        continue;
+      }
+      int e = f.edge++;
+      int v = g.targets[e];
+      if (onPath.test(v))
+        continue;
+      long long cost = f.cost + g.cost(e);
+      long long fv = cost + g.heuristic[v];
+      if (fv > bound) {
+        nextBound = std::min(nextBound, fv);
+        continue;
+      }
+      onPath.set(v);
+      stack.push_back({v, g.offsets[v], cost});
+      r.generated++;
+      firstVisit = true;
+    }
+    bound = nextBound;
+  }
+  return r;
+}
+
+inline IDAStarResult idaStar(const CSRGraph &g, int start, int goal,
+                             std::ostream &out = std::cout) {
+  IDAStarResult r = runIDAStar(g, start, goal);
+  if (!r.found) {
+    out << "No path found\n";
+    return r;
+  }
+  out << "Path: ";
+  printPath(g, r.path, out);
+  out << "Path cost: " << r.cost << "\n";
+  out << "Nodes expanded: " << r.expanded << ", re-expanded: " << r.reexpanded
+      << "\n";
+  out << "Iterations: " << r.iterations << "\n";
+  return r;
+}
 
-  std::priority_queue<PQNode, std::vector<PQNode>, std::greater<PQNode>> pq;
-  pq.push(PQNode(start, g.heuristic[start], {start}));
-  std::unordered_set<char> visited;
+// Queue behind runDijkstra. kAuto takes Dial's buckets when the largest
+// door cost is at most kMaxBucketCost (one bucket per possible cost) and
+// the indexed heap otherwise; past a few thousand, scanning empty buckets
+// costs more than the heap (see the dijkstra rows of bench --max-cost).
+enum class DijkstraQueue { kAuto, kBuckets, kHeap };
+constexpr int kMaxBucketCost = 4096;
 
-  while (!pq.empty()) {
-    auto current = pq.top();
-    pq.pop();
-    if (visited.count(current.node))
+struct DijkstraResult : SearchResult {
+  bool buckets = false; // which queue ran
+};
+
+// Dijkstra's main loop over either queue. `push` inserts or improves an
+// entry; a queue that keeps stale entries has them skipped via `done`.
+template <class Queue, class Push>
+inline void dijkstraLoop(const CSRGraph &g, int start, int goal, Queue &open,
+                         Push push, DijkstraResult &r) {
+  const long long kInf = std::numeric_limits<long long>::max();
+  std::vector<long long> best(g.size(), kInf);
+  std::vector<int> parent(g.size(), -1);
+  std::vector<char> done(g.size(), 0);
+  best[start] = 0;
+  push(start, 0);
+  r.generated = 1;
+  while (!open.empty()) {
+    r.peakFrontier = std::max(r.peakFrontier, open.size());
+    int u = open.pop();
+    if (done[u])
       continue;
-    visited.insert(current.node);
+    done[u] = 1;
+    r.expanded++;
+    if (u == goal) {
+      r.found = true;
+      r.cost = best[u];
+      r.path = tracePath(parent, goal);
+      return;
+    }
+    for (int e = g.offsets[u]; e < g.offsets[u + 1]; e++) {
+      int v = g.targets[e];
+      long long cand = best[u] + g.cost(e);
+      if (done[v] || cand >= best[v])
+        continue;
+      best[v] = cand;
+      parent[v] = u;
+      push(v, cand);
+      r.generated++;
+    }
+  }
+}
 
-    if (current.node == goal) {
-      out << "Path: ";
-      printPathChar(current.path, out);
+// Cheapest path by door cost. Costs must be non-negative; unweighted
+// graphs cost 1 per door, where the bucket queue behaves like BFS.
+inline DijkstraResult runDijkstra(const CSRGraph &g, int start, int goal,
+                                  DijkstraQueue queue = DijkstraQueue::kAuto) {
+  DijkstraResult r;
+  if (start < 0 || goal < 0)
+    return r;
+  r.buckets = queue == DijkstraQueue::kBuckets ||
+              (queue == DijkstraQueue::kAuto && g.maxCost <= kMaxBucketCost);
+  if (r.buckets) {
+    BucketQueue open(g.maxCost);
+    dijkstraLoop(
+        g, start, goal, open,
+        [&](int v, long long key) { open.push(v, key); }, r);
+  } else {
+    IndexedHeap<long long> open(g.size());
+    dijkstraLoop(
+        g, start, goal, open,
+        [&](int v, long long key) { open.pushOrDecrease(v, key); }, r);
+  }
+  return r;
+}
+
+inline DijkstraResult dijkstra(const CSRGraph &g, int start, int goal,
+                               std::ostream &out = std::cout,
+                               DijkstraQueue queue = DijkstraQueue::kAuto) {
+  DijkstraResult r = runDijkstra(g, start, goal, queue);
+  if (!r.found) {
+    out << "No path found\n";
+    return r;
+  }
+  out << "Path: ";
+  printPath(g, r.path, out);
+  out << "Path cost: " << r.cost << "\n";
+  out << "Nodes expanded: " << r.expanded << " ("
+      << (r.buckets ? "bucket queue" : "indexed heap") << ")\n";
+  return r;
+}
+
+// Yen's k shortest simple paths: the best k routes from start to goal in
+// order of door cost, for alternatives when a door is blocked. Each route
+// after the first comes from Dijkstra "spur" searches that leave the
+// previous route at one of its rooms while avoiding the rooms before it and
+// the doors already taken there. Following Lawler, route i only spurs from
+// the room where it left its parent onwards (earlier spurs were tried for
+// the parent), so the work is O(k * route length) Dijkstras, independent of
+// how many simple paths the house has.
+struct KShortestResult : SearchResult {
+  std::vector<std::vector<int>> paths; // cheapest first; `path` is paths[0]
+  std::vector<long long> costs;
+  long long spurSearches = 0;
+};
+
+// Cheapest path from `spur` to `goal` that avoids the rooms in `blocked`
+// and, out of `spur` itself, the rooms in `cut`. Returns its cost, or -1.
+inline long long spurPath(const CSRGraph &g, int spur, int goal,
+                          const Bitmap &blocked, const Bitmap &cut,
+                          SearchWorkspace &s, std::vector<int> &path,
+                          long long &expanded) {
+  s.begin(g.size());
+  auto reach = [&](int v, long long cost, int from) {
+    if (s.seen(v) && s.best[v] <= cost)
       return;
+    s.see(v, from);
+    s.best[v] = cost;
+    s.open.pushOrDecrease(v, {cost, 0});
+  };
+  reach(spur, 0, -1);
+  while (!s.open.empty()) {
+    int u = s.open.pop();
+    expanded++;
+    if (u == goal) {
+      path = s.trace(goal);
+      return s.best[goal];
     }
+    for (int e = g.offsets[u]; e < g.offsets[u + 1]; e++) {
+      int v = g.targets[e];
+      if (!blocked.test(v) && !(u == spur && cut.test(v)))
+        reach(v, s.best[u] + g.cost(e), u);
+    }
+  }
+  return -1;
+}
 
-    for (char neighbor : g.adjlist[current.node]) {
-      if (std::find(current.path.begin(), current.path.end(), neighbor) ==
-          current.path.end()) {
-        std::vector<char> new_path = current.path;
-        new_path.push_back(neighbor);
-        pq.push(PQNode(neighbor, g.heuristic[neighbor], new_path));
+inline KShortestResult runKShortestPaths(const CSRGraph &g, int start,
+                                         int goal, int k) {
+  KShortestResult r;
+  if (start < 0 || goal < 0 || k <= 0)
+    return r;
+  SearchWorkspace scratch; // shared by every spur search of this call
+  Bitmap blocked(g.size()), cut(g.size());
+  std::vector<int> path;
+  r.spurSearches = 1;
+  long long cost =
+      spurPath(g, start, goal, blocked, cut, scratch, path, r.expanded);
+  if (cost < 0)
+    return r;
+  // Cheapest door between two consecutive rooms of a route.
+  auto doorCost = [&](int u, int v) {
+    long long c = std::numeric_limits<long long>::max();
+    for (int e = g.offsets[u]; e < g.offsets[u + 1]; e++)
+      if (g.targets[e] == v)
+        c = std::min<long long>(c, g.cost(e));
+    return c;
+  };
+  // Candidates come out by cost, then room ids; each remembers the index
+  // where it left the route it was spurred from.
+  struct Candidate {
+    long long cost;
+    std::vector<int> path;
+    size_t deviation;
+    bool operator>(const Candidate &o) const {
+      return std::tie(cost, path) > std::tie(o.cost, o.path);
+    }
+  };
+  std::priority_queue<Candidate, std::vector<Candidate>, std::greater<>>
+      candidates;
+  std::set<std::vector<int>> seen{path};
+  std::vector<size_t> deviation{0};
+  r.paths.push_back(path);
+  r.costs.push_back(cost);
+  while (int(r.paths.size()) < k) {
+    const std::vector<int> last = r.paths.back();
+    long long rootCost = 0;
+    for (size_t i = 0; i < deviation.back(); i++)
+      rootCost += doorCost(last[i], last[i + 1]);
+    for (size_t i = deviation.back(); i + 1 < last.size(); i++) {
+      for (size_t j = 0; j < i; j++)
+        blocked.set(last[j]);
+      for (const std::vector<int> &p : r.paths)
+        if (p.size() > i + 1 && std::equal(last.begin(), last.begin() + i + 1,
+                                           p.begin()))
+          cut.set(p[i + 1]);
+      r.spurSearches++;
+      long long spurCost =
+          spurPath(g, last[i], goal, blocked, cut, scratch, path, r.expanded);
+      if (spurCost >= 0) {
+        std::vector<int> route(last.begin(), last.begin() + i);
+        route.insert(route.end(), path.begin(), path.end());
+        if (seen.insert(route).second) {
+          candidates.push({rootCost + spurCost, std::move(route), i});
+          r.generated++;
+        }
       }
+      blocked.clear();
+      cut.clear();
+      rootCost += doorCost(last[i], last[i + 1]);
+    }
+    r.peakFrontier = std::max(r.peakFrontier, candidates.size());
+    if (candidates.empty())
+      break;
+    Candidate next = candidates.top();
+    candidates.pop();
+    r.costs.push_back(next.cost);
+    r.paths.push_back(std::move(next.path));
+    deviation.push_back(next.deviation);
+  }
+  r.found = true;
+  r.path = r.paths[0];
+  r.cost = r.costs[0];
+  return r;
+}
+
+inline KShortestResult kShortestPaths(const CSRGraph &g, int start,
+                                      int goal, int k,
+                                      std::ostream &out = std::cout) {
+  KShortestResult r = runKShortestPaths(g, start, goal, k);
+  if (!r.found) {
+    out << "No path found\n";
+    return r;
+  }
+  for (size_t i = 0; i < r.paths.size(); i++) {
+    out << "Path " << i + 1 << " (cost " << r.costs[i] << "): ";
+    printPath(g, r.paths[i], out);
+  }
+  if (int(r.paths.size()) < k)
+    out << "Only " << r.paths.size() << " simple paths exist\n";
+  out << "Spur searches: " << r.spurSearches
+      << ", nodes expanded: " << r.expanded << "\n";
+  return r;
+}
+
+// Routes listed by the k-shortest-paths section unless the menu sets k.
+constexpr int kDefaultRoutes = 3;
+
+// One section of the Run ALL report: what its printer wrote, the result it
+// returned (names resolved through `graph`) and what the call cost. The
+// metrics cover the printer, so they include formatting its text.
+struct ReportSection {
+  std::string title;
+  std::string text;
+  SearchResult result;
+  const CSRGraph *graph = nullptr;
+  SearchMetrics metrics;
+};
+
+// Runs every algorithm of the report once and keeps each printer's output,
+// so the same report can be written to the console, output.txt and JSON
+// without searching again. With a pool the sections run concurrently, the
+// slowest (British Museum, IDA*, K shortest paths) first; the sections come
+// back in report order either way. Nothing in a section uses the pool.
+// `hardware` adds perf counters to each section's metrics (instrument.h).
+// Heap figures are per thread, so concurrent sections keep their own; their
+// times include competing for the cores.
+inline std::vector<ReportSection>
+runAllAlgorithms(const CSRGraph &rooms, int src, int dest,
+                 const CSRGraph &house, int hstart, int hgoal, int beamwidth,
+                 int routes = kDefaultRoutes, ThreadPool *pool = nullptr,
+                 bool hardware = false) {
+  using Run = std::function<SearchResult(std::ostream &)>;
+  struct Job {
+    std::string title;
+    const CSRGraph *graph;
+    Run run;
+    bool slow = false; // started first when the sections run concurrently
+  };
+  const CSRGraph *r = &rooms, *h = &house;
+  std::vector<Job> jobs = {
+      {"BFS (forward)", r,
+       [&](std::ostream &o) { return bfs(rooms, src, dest, false, o); }},
+      {"BFS (reverse)", r,
+       [&](std::ostream &o) { return bfs(rooms, src, dest, true, o); }},
+      {"Direction-optimizing BFS", r,
+       [&](std::ostream &o) {
+         return directionOptimizingBFS(rooms, src, dest, o);
+       }},
+      {"Bidirectional BFS", r,
+       [&](std::ostream &o) { return biBFS(rooms, src, dest, o); }},
+      {"DFS (forward)", r,
+       [&](std::ostream &o) { return dfs(rooms, src, dest, false, o); }},
+      {"DFS (reverse)", r,
+       [&](std::ostream &o) { return dfs(rooms, src, dest, true, o); }},
+      {"British Museum (forward)", r,
+       [&](std::ostream &o) {
+         return britishMuseum(rooms, src, dest, false, o);
+       },
+       true},
+      {"British Museum (reverse)", r,
+       [&](std::ostream &o) {
+         return britishMuseum(rooms, src, dest, true, o);
+       },
+       true},
+      {"Hill Climbing", h,
+       [&](std::ostream &o) { return hillclimbing(house, hstart, hgoal, o); }},
+      {"Hill Climbing (random restart)", h,
+       [&](std::ostream &o) {
+         return hillClimbEngine(house, hstart, hgoal, HillClimbOptions(),
+                                nullptr, o);
+       }},
+      {"Beam Search", h,
+       [&](std::ostream &o) {
+         return beamsearch(house, hstart, hgoal, beamwidth, o);
+       }},
+      {"Best First Search", h,
+       [&](std::ostream &o) {
+         return bestFirstSearch(house, hstart, hgoal, o);
+       }},
+      {"A* Search", h,
+       [&](std::ostream &o) { return aStar(house, hstart, hgoal, o); }},
+      {"IDA* Search", h,
+       [&](std::ostream &o) { return idaStar(house, hstart, hgoal, o); },
+       true},
+      {"Dijkstra", r,
+       [&](std::ostream &o) { return dijkstra(rooms, src, dest, o); }},
+      {"K Shortest Paths (k = " + std::to_string(routes) + ")", r,
+       [&](std::ostream &o) {
+         return kShortestPaths(rooms, src, dest, routes, o);
+       },
+       true},
+  };
+
+  std::vector<ReportSection> sections(jobs.size());
+  auto runSection = [&](int i) {
+    std::ostringstream text;
+    ReportSection &section = sections[i];
+    section.result = measureSearch(
+        jobs[i].title, [&] { return jobs[i].run(text); }, section.metrics,
+        hardware);
+    section.title = jobs[i].title;
+    section.text = text.str();
+    section.graph = jobs[i].graph;
+  };
+  if (!pool || pool->size() < 2) {
+    for (size_t i = 0; i < jobs.size(); i++)
+      runSection(int(i));
+    return sections;
+  }
+  std::vector<int> order(jobs.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_partition(order.begin(), order.end(),
+                        [&](int i) { return jobs[i].slow; });
+  pool->parallelFor(int(order.size()), [&](int k) { runSection(order[k]); });
+  return sections;
+}
+
+// The report as text: each section under a separator and its title.
+inline void writeReport(const std::vector<ReportSection> &sections,
+                        std::ostream &out) {
+  for (const ReportSection &s : sections)
+    out << "==============================\n" << s.title << ":\n" << s.text;
+  out << "==============================\n";
+}
+
+// The report as JSON lines: each section's metrics (instrument.h) and its
+// path in room names; the printed text is left out.
+inline void writeReportJson(const std::vector<ReportSection> &sections,
+                            std::ostream &out) {
+  for (const ReportSection &s : sections) {
+    out << "{";
+    writeMetricsFields(s.metrics, out);
+    out << ", \"path\": [";
+    for (size_t j = 0; j < s.result.path.size(); j++) {
+      if (j)
+        out << ", ";
+      writeJsonString(s.graph->name(s.result.path[j]), out);
     }
+    out << "]}\n";
   }
-  out << "No path found\n";
+}
+
+// `rooms` drives the uninformed searches, `house` (with heuristics) the
+// informed ones; both may be the same graph.
+inline void run_all_algorithms(const CSRGraph &rooms, int src, int dest,
+                               const CSRGraph &house, int hstart, int hgoal,
+                               int beamwidth, std::ostream &out,
+                               int routes = kDefaultRoutes) {
+  writeReport(runAllAlgorithms(rooms, src, dest, house, hstart, hgoal,
+                               beamwidth, routes),
+              out);
 }
 
 inline void
@@ -349,35 +1621,9 @@ run_all_algorithms(const std::string &src, const std::string &dest,
                    const std::map<std::string, std::vector<std::string>> &adj,
                    char hstart, char hgoal, graph &G, int beamwidth,
                    std::ostream &out) {
-  out << "==============================\n";
-  out << "BFS (forward):\n";
-  bfs(src, dest, adj, false, out);
-  out << "==============================\n";
-  out << "BFS (reverse):\n";
-  bfs(src, dest, adj, true, out);
-  out << "==============================\n";
-  out << "Bidirectional BFS:\n";
-  biBFS(src, dest, adj, out);
-  out << "==============================\n";
-  out << "DFS (forward):\n";
-  dfs(src, dest, adj, false, out);
-  out << "==============================\n";
-  out << "DFS (reverse):\n";
-  dfs(src, dest, adj, true, out);
-  out << "==============================\n";
-  out << "British Museum (forward):\n";
-  britishMuseum(src, adj, dest, false, out);
-  out << "==============================\n";
-  out << "British Museum (reverse):\n";
-  britishMuseum(src, adj, dest, true, out);
-  out << "==============================\n";
-  out << "Hill Climbing:\n";
-  hillclimbing(hstart, hgoal, G, out);
-  out << "==============================\n";
-  out << "Beam Search:\n";
-  beamsearch(hstart, hgoal, G, beamwidth, out);
-  out << "==============================\n";
-  out << "Best First Search:\n";
-  bestFirstSearch(hstart, hgoal, G, out);
-  out << "==============================\n";
+  CSRGraph rooms = buildCSR(adj);
+  CSRGraph house = buildCSR(G);
+  run_all_algorithms(rooms, rooms.id(src), rooms.id(dest), house,
+                     house.id(std::string(1, hstart)),
+                     house.id(std::string(1, hgoal)), beamwidth, out);
 }
@@ -0,0 +1,425 @@
+// Repeatable benchmark for the searches in algo.h on generated house graphs.
+//
+//   g++ -O2 -std=c++17 -pthread bench.cpp -o bench
+//   ./bench [--graph grid|geometric|tree|scalefree|all] [--nodes N]
+//           [--runs R] [--beam W] [--bms-nodes M] [--max-cost C]
+//           [--seed S] [--format csv|json|jsonl] [--out FILE]
+//           [--counters 1]
+//
+// Each graph is generated from the seed, the query runs from R0 to the room
+// farthest from it (so every search has a reachable goal), and each
+// algorithm is timed `runs` times; building a contraction hierarchy is
+// timed once. British Museum search and IDA* can take exponential time, so
+// they run on a separate instance of the same family with `bms-nodes`
+// rooms. The Dijkstra rows run on a copy whose doors cost 1..C (default
+// 16), once on Dial's buckets and once on the indexed heap, and so do the
+// D* Lite rows: dstar_lite plans from scratch, dstar_replan closes the
+// middle door of the route, repairs, reopens it and repairs again. The
+// bfs_workspace / astar_workspace rows run BFS and A* on one
+// SearchWorkspace kept across runs instead of allocating per call.
+// astar_stepped runs A* through SteppedAStar, kClockStride expansions per
+// step, to show what pausing every few expansions costs.
+// Each run is measured by a SearchProbe (instrument.h): peak heap is the
+// most memory the search had allocated at once and allocated bytes all it
+// asked for, both tracked by the INSTRUMENT_HEAP operator new / delete on
+// the calling thread (the parallel rows' worker allocations are not
+// included).
+// `--counters 1` adds cycles, instructions, cache and branch misses from
+// perf_event_open where the kernel allows it. Every figure is the one of
+// the run with the median time. jsonl writes one JSON object per row.
+#define INSTRUMENT_HEAP
+#include "algo.h"
+#include "cli_args.h"
+#include "contraction_hierarchy.h"
+#include "dstar_lite.h"
+#include "graph_gen.h"
+#include "landmarks.h"
+#include "parallel_bfs.h"
+#include "parallel_bms.h"
+#include "stepped_search.h"
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct BenchAlgo {
+  std::string name;
+  std::function<SearchResult(const CSRGraph &, int, int)> run;
+  bool exhaustive = false; // run on the small instance only
+  bool once = false;       // preprocessing; timed a single time
+};
+
+struct BenchRow {
+  std::string graph, algorithm;
+  int nodes, edges, runs;
+  double medianUs, p99Us;
+  SearchResult result;
+  SearchMetrics metrics; // of the median run
+};
+
+struct Query {
+  GeneratedGraph gg;
+  CSRGraph g;    // gg.g with the heuristic for `goal`
+  CSRGraph altG; // gg.g with ALT landmark bounds for `goal`
+  CSRGraph priced; // gg.g with random door costs
+  ContractionHierarchy ch;
+  std::unique_ptr<DynamicGraph> doors; // priced, for D* Lite
+  std::unique_ptr<DStarLite> planner;  // planned once, kept up to date
+  int src, goal;
+};
+
+constexpr int kBenchLandmarks = 16;
+constexpr int kBenchRoutes = 8;
+
+static Query makeQuery(const std::string &kind, int nodes, int maxCost,
+                       uint64_t seed, ThreadPool &pool) {
+  Query q;
+  if (kind == "grid") {
+    int side = std::max(2, int(std::sqrt(double(nodes))));
+    q.gg = gridFloorPlan(side, side, 0.15, seed);
+  } else if (kind == "geometric") {
+    q.gg = randomGeometric(nodes, 8, seed);
+  } else if (kind == "tree") {
+    q.gg = treeWithBackEdges(nodes, 0.1, seed);
+  } else {
+    q.gg = scaleFree(nodes, 3, seed);
+  }
+  q.src = 0;
+  std::vector<int> dist = hopDistances(q.gg.g, q.src);
+  q.goal = int(std::max_element(dist.begin(), dist.end()) - dist.begin());
+  q.g = withHeuristic(q.gg.g, heuristicFor(q.gg, q.goal));
+  LandmarkIndex alt = buildLandmarks(q.gg.g, kBenchLandmarks, pool);
+  q.altG =
+      withHeuristic(q.gg.g, landmarkHeuristic(alt, q.g.size(), q.goal));
+  q.ch.build(q.gg.g);
+  q.priced = withRandomCosts(q.gg.g, maxCost, seed);
+  q.doors = std::make_unique<DynamicGraph>(q.priced);
+  q.planner = std::make_unique<DStarLite>(*q.doors, q.src, q.goal);
+  q.planner->plan();
+  return q;
+}
+
+// Closes the middle door of the planned route (both ways) and repairs the
+// plan, then reopens it and repairs again. The result is the detour, with
+// the work of both repairs.
+static SearchResult closeAndReopen(DynamicGraph &doors, DStarLite &planner) {
+  ReplanResult r = planner.plan(); // already up to date: only reads the path
+  if (r.path.size() < 2)
+    return r;
+  size_t i = (r.path.size() - 1) / 2;
+  int u = r.path[i], v = r.path[i + 1];
+  int forward = doors.removeDoor(u, v), back = doors.removeDoor(v, u);
+  planner.doorChanged(u, v, forward);
+  planner.doorChanged(v, u, back);
+  ReplanResult detour = planner.plan();
+  doors.setDoor(u, v, forward);
+  planner.doorChanged(u, v, -1);
+  if (back != -1) {
+    doors.setDoor(v, u, back);
+    planner.doorChanged(v, u, -1);
+  }
+  ReplanResult restored = planner.plan();
+  detour.expanded += restored.expanded;
+  detour.generated += restored.generated;
+  detour.peakFrontier = std::max(detour.peakFrontier, restored.peakFrontier);
+  return detour;
+}
+
+static BenchRow measure(const BenchAlgo &algo, const Query &q, int runs,
+                        SearchProbe &probe) {
+  BenchRow row{q.gg.kind, algo.name, q.g.size(), q.g.edgeCount(), runs,
+               0,         0,         {},         {}};
+  std::vector<SearchMetrics> each;
+  for (int i = 0; i < runs; i++) {
+    probe.start();
+    SearchResult r = algo.run(q.g, q.src, q.goal);
+    each.push_back(probe.stop(algo.name, r));
+    row.result = std::move(r);
+  }
+  std::sort(each.begin(), each.end(),
+            [](const SearchMetrics &a, const SearchMetrics &b) {
+              return a.ms < b.ms;
+            });
+  row.metrics = each[each.size() / 2];
+  row.medianUs = row.metrics.ms * 1e3;
+  size_t p99 = (each.size() * 99 + 99) / 100 - 1;
+  row.p99Us = each[std::min(each.size() - 1, p99)].ms * 1e3;
+  return row;
+}
+
+// An unknown count is an empty CSV field and a JSON null.
+static std::string csvCount(long long v) {
+  return v < 0 ? std::string() : std::to_string(v);
+}
+static std::string jsonCount(long long v) {
+  return v < 0 ? std::string("null") : std::to_string(v);
+}
+
+static void writeCsv(const std::vector<BenchRow> &rows, std::ostream &out) {
+  out << "graph,nodes,edges,algorithm,runs,median_us,p99_us,found,path_len,"
+         "expanded,generated,peak_frontier,peak_heap_bytes,allocated_bytes,"
+         "cycles,instructions,cache_misses,branch_misses\n";
+  for (const BenchRow &r : rows) {
+    const SearchMetrics &m = r.metrics;
+    out << r.graph << ',' << r.nodes << ',' << r.edges << ',' << r.algorithm
+        << ',' << r.runs << ',' << r.medianUs << ',' << r.p99Us << ','
+        << r.result.found << ',' << r.result.path.size() << ','
+        << r.result.expanded << ',' << r.result.generated << ','
+        << r.result.peakFrontier << ',' << csvCount(m.peakHeapBytes) << ','
+        << csvCount(m.allocatedBytes) << ',' << csvCount(m.cycles) << ','
+        << csvCount(m.instructions) << ',' << csvCount(m.cacheMisses) << ','
+        << csvCount(m.branchMisses) << '\n';
+  }
+}
+
+static void writeJson(const std::vector<BenchRow> &rows, std::ostream &out) {
+  out << "[\n";
+  for (size_t i = 0; i < rows.size(); i++) {
+    const BenchRow &r = rows[i];
+    out << "  {\"graph\": \"" << r.graph << "\", \"nodes\": " << r.nodes
+        << ", \"edges\": " << r.edges << ", \"algorithm\": \"" << r.algorithm
+        << "\", \"runs\": " << r.runs << ", \"median_us\": " << r.medianUs
+        << ", \"p99_us\": " << r.p99Us
+        << ", \"found\": " << (r.result.found ? "true" : "false")
+        << ", \"path_len\": " << r.result.path.size()
+        << ", \"expanded\": " << r.result.expanded
+        << ", \"generated\": " << r.result.generated
+        << ", \"peak_frontier\": " << r.result.peakFrontier
+        << ", \"peak_heap_bytes\": " << jsonCount(r.metrics.peakHeapBytes)
+        << ", \"allocated_bytes\": " << jsonCount(r.metrics.allocatedBytes)
+        << ", \"cycles\": " << jsonCount(r.metrics.cycles)
+        << ", \"instructions\": " << jsonCount(r.metrics.instructions)
+        << ", \"cache_misses\": " << jsonCount(r.metrics.cacheMisses)
+        << ", \"branch_misses\": " << jsonCount(r.metrics.branchMisses) << "}"
+        << (i + 1 < rows.size() ? ",\n" : "\n");
+  }
+  out << "]\n";
+}
+
+// One line per row: the row's graph and timing, then the median run's
+// metrics as instrument.h writes them.
+static void writeJsonLines(const std::vector<BenchRow> &rows,
+                           std::ostream &out) {
+  for (const BenchRow &r : rows) {
+    out << "{\"graph\": \"" << r.graph << "\", \"nodes\": " << r.nodes
+        << ", \"edges\": " << r.edges << ", \"runs\": " << r.runs
+        << ", \"median_us\": " << r.medianUs << ", \"p99_us\": " << r.p99Us
+        << ", ";
+    writeMetricsFields(r.metrics, out);
+    out << "}\n";
+  }
+}
+
+int main(int argc, char **argv) {
+  std::string graphKind = "all", format = "csv", outFile;
+  int nodes = 10000, runs = 21, beamwidth = 4, bmsNodes = 16, maxCost = 16;
+  uint64_t seed = 42;
+  bool counters = false;
+  auto usage = [&] {
+    std::cout << "Usage: " << argv[0]
+              << " [--graph grid|geometric|tree|scalefree|all] [--nodes N]\n"
+                 "         [--runs R] [--beam W] [--bms-nodes M] "
+                 "[--max-cost C]\n"
+                 "         [--seed S] [--format csv|json|jsonl] [--out FILE]\n"
+                 "         [--counters 1]\n";
+    return 1;
+  };
+  for (int i = 1; i < argc; i += 2) {
+    if (i + 1 == argc)
+      return usage(); // a flag without its value
+    std::string flag = argv[i], value = argv[i + 1];
+    bool ok = true;
+    if (flag == "--graph")
+      graphKind = value;
+    else if (flag == "--nodes")
+      ok = parseNumber(value, nodes);
+    else if (flag == "--runs")
+      ok = parseNumber(value, runs);
+    else if (flag == "--beam")
+      ok = parseNumber(value, beamwidth);
+    else if (flag == "--bms-nodes")
+      ok = parseNumber(value, bmsNodes);
+    else if (flag == "--max-cost")
+      ok = parseNumber(value, maxCost);
+    else if (flag == "--seed")
+      ok = parseNumber(value, seed);
+    else if (flag == "--format")
+      format = value;
+    else if (flag == "--out")
+      outFile = value;
+    else if (flag == "--counters")
+      counters = value != "0";
+    else {
+      std::cout << "Unknown option " << flag << "\n";
+      return usage();
+    }
+    if (!ok) {
+      std::cout << "Bad value for " << flag << ": " << value << "\n";
+      return usage();
+    }
+  }
+  runs = std::max(1, runs);
+  maxCost = std::max(1, maxCost);
+
+  ThreadPool pool;
+  SearchWorkspace ws;       // kept across runs by the *_workspace rows
+  Query *current = nullptr; // the instance being measured
+  auto hillOpts = [&](HillClimbMode mode) {
+    HillClimbOptions opts;
+    opts.mode = mode;
+    opts.seed = seed;
+    return opts;
+  };
+  std::vector<BenchAlgo> algos = {
+      {"bfs",
+       [](const CSRGraph &g, int s, int t) { return runBFS(g, s, t); }},
+      {"bfs_workspace",
+       [&](const CSRGraph &g, int s, int t) { return runBFS(g, s, t, ws); }},
+      {"dobfs",
+       // Generated doors are undirected, so g is its own transpose.
+       [](const CSRGraph &g, int s, int t) {
+         return SearchResult(runDirectionOptimizingBFS(g, g, s, t));
+       }},
+      {"parallel_bfs",
+       [&](const CSRGraph &g, int s, int t) {
+         return runParallelBFS(g, s, t, pool);
+       }},
+      {"dfs",
+       [](const CSRGraph &g, int s, int t) { return runDFS(g, s, t); }},
+      {"bibfs",
+       [](const CSRGraph &g, int s, int t) { return runBiBFS(g, s, t); }},
+      {"parallel_bibfs",
+       [&](const CSRGraph &g, int s, int t) {
+         return runParallelBiBFS(g, s, t, pool);
+       }},
+      {"british_museum",
+       [](const CSRGraph &g, int s, int t) {
+         return SearchResult(runBritishMuseum(g, s, t, nullptr));
+       },
+       true},
+      {"parallel_bms",
+       [&](const CSRGraph &g, int s, int t) {
+         return SearchResult(runParallelBritishMuseum(g, s, t, pool, nullptr));
+       },
+       true},
+      {"hillclimbing",
+       [](const CSRGraph &g, int s, int t) {
+         return runHillClimbing(g, s, t);
+       }},
+      {"hill_first_choice",
+       [&](const CSRGraph &g, int s, int t) {
+         return SearchResult(
+             runHillClimbEngine(g, s, t, hillOpts(HillClimbMode::kFirstChoice),
+                                &pool));
+       }},
+      {"hill_restart",
+       [&](const CSRGraph &g, int s, int t) {
+         return SearchResult(runHillClimbEngine(
+             g, s, t, hillOpts(HillClimbMode::kRandomRestart), &pool));
+       }},
+      {"hill_annealing",
+       [&](const CSRGraph &g, int s, int t) {
+         return SearchResult(
+             runHillClimbEngine(g, s, t, hillOpts(HillClimbMode::kAnnealing),
+                                &pool));
+       }},
+      {"beamsearch",
+       [&](const CSRGraph &g, int s, int t) {
+         return runBeamSearch(g, s, t, beamwidth);
+       }},
+      {"parallel_beamsearch",
+       [&](const CSRGraph &g, int s, int t) {
+         return runParallelBeamSearch(g, s, t, beamwidth, pool);
+       }},
+      {"bestfirst",
+       [](const CSRGraph &g, int s, int t) {
+         return runBestFirstSearch(g, s, t);
+       }},
+      {"astar",
+       [](const CSRGraph &g, int s, int t) { return runAStar(g, s, t); }},
+      {"astar_workspace",
+       [&](const CSRGraph &g, int s, int t) { return runAStar(g, s, t, ws); }},
+      {"astar_stepped",
+       [](const CSRGraph &g, int s, int t) {
+         SteppedAStar search(g, s, t);
+         while (search.step(kClockStride) == StepStatus::kRunning)
+           ;
+         return search.result();
+       }},
+      {"astar_alt",
+       [&](const CSRGraph &, int s, int t) {
+         return runAStar(current->altG, s, t);
+       }},
+      {"dijkstra_dial",
+       [&](const CSRGraph &, int s, int t) {
+         return SearchResult(
+             runDijkstra(current->priced, s, t, DijkstraQueue::kBuckets));
+       }},
+      {"dijkstra_heap",
+       [&](const CSRGraph &, int s, int t) {
+         return SearchResult(
+             runDijkstra(current->priced, s, t, DijkstraQueue::kHeap));
+       }},
+      {"dstar_lite",
+       [&](const CSRGraph &, int s, int t) {
+         return SearchResult(DStarLite(*current->doors, s, t).plan());
+       }},
+      {"dstar_replan",
+       [&](const CSRGraph &, int, int) {
+         return closeAndReopen(*current->doors, *current->planner);
+       }},
+      {"yen_k8",
+       [](const CSRGraph &g, int s, int t) {
+         return SearchResult(runKShortestPaths(g, s, t, kBenchRoutes));
+       }},
+      {"ch_build",
+       [](const CSRGraph &g, int s, int t) {
+         ContractionHierarchy ch(g);
+         return ch.query(s, t);
+       },
+       false, true},
+      {"ch_query",
+       [&](const CSRGraph &, int s, int t) { return current->ch.query(s, t); }},
+      // IDA* re-walks every path under each bound, so it gets the small
+      // instance like British Museum search.
+      {"idastar",
+       [](const CSRGraph &g, int s, int t) {
+         return SearchResult(runIDAStar(g, s, t));
+       },
+       true},
+  };
+
+  std::vector<std::string> kinds = {"grid", "geometric", "tree", "scalefree"};
+  if (graphKind != "all")
+    kinds = {graphKind};
+  std::vector<BenchRow> rows;
+  SearchProbe probe(counters);
+  for (const std::string &kind : kinds) {
+    Query big = makeQuery(kind, nodes, maxCost, seed, pool);
+    Query small = makeQuery(kind, bmsNodes, maxCost, seed, pool);
+    for (const BenchAlgo &algo : algos) {
+      current = algo.exhaustive ? &small : &big;
+      rows.push_back(measure(algo, *current, algo.once ? 1 : runs, probe));
+    }
+  }
+
+  std::ofstream file;
+  if (!outFile.empty()) {
+    file.open(outFile);
+    if (!file.is_open()) {
+      std::cout << "Could not open " << outFile << "\n";
+      return 1;
+    }
+  }
+  std::ostream &out = outFile.empty() ? std::cout : file;
+  if (format == "json")
+    writeJson(rows, out);
+  else if (format == "jsonl")
+    writeJsonLines(rows, out);
+  else
+    writeCsv(rows, out);
+  return 0;
+}
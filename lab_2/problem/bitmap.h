@@ -0,0 +1,51 @@
+/*
+
+    Dense bit sets over node ids, one bit per room, used for frontier and
+   visited sets where a byte-per-node vector would waste cache.
+   AtomicBitmap is the variant shared between threads.
+*/
+
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+struct Bitmap {
+  std::vector<uint64_t> words;
+
+  Bitmap() = default;
+  explicit Bitmap(int n) : words((n + 63) / 64, 0) {}
+
+  bool test(int i) const { return (words[i >> 6] >> (i & 63)) & 1; }
+  void set(int i) { words[i >> 6] |= uint64_t(1) << (i & 63); }
+  void reset(int i) { words[i >> 6] &= ~(uint64_t(1) << (i & 63)); }
+  void clear() { std::fill(words.begin(), words.end(), 0); }
+  void swap(Bitmap &other) { words.swap(other.words); }
+
+  int count() const {
+    int c = 0;
+    for (uint64_t w : words)
+      c += __builtin_popcountll(w);
+    return c;
+  }
+};
+
+struct AtomicBitmap {
+  std::vector<std::atomic<uint64_t>> words;
+
+  explicit AtomicBitmap(int n) : words((n + 63) / 64) {
+    for (auto &w : words)
+      w.store(0, std::memory_order_relaxed);
+  }
+
+  bool test(int i) const {
+    return (words[i >> 6].load(std::memory_order_relaxed) >> (i & 63)) & 1;
+  }
+
+  // Sets bit i; true only for the one caller that flipped it from 0 to 1.
+  bool claim(int i) {
+    uint64_t bit = uint64_t(1) << (i & 63);
+    return !(words[i >> 6].fetch_or(bit, std::memory_order_relaxed) & bit);
+  }
+};
@@ -0,0 +1,52 @@
+/*
+
+    Dial's bucket queue for Dijkstra with small integer door costs.
+
+    Keys must be pushed in [last popped key, last popped key + maxCost],
+   which holds for Dijkstra when every door costs at most maxCost, so
+   maxCost + 1 buckets used as a ring cover every live key and each bucket
+   holds a single key. push and pop are O(1) plus the scan over empty
+   buckets, at most maxCost per pop.
+
+    There is no decrease-key: a better key is pushed again and the caller
+   skips the stale entry when it is popped (it is already settled by then).
+*/
+
+#pragma once
+#include <cstddef>
+#include <vector>
+
+class BucketQueue {
+public:
+  explicit BucketQueue(int maxCost = 1) : buckets(size_t(maxCost) + 1) {}
+
+  bool empty() const { return count == 0; }
+  size_t size() const { return count; }
+
+  void push(int id, long long key) {
+    buckets[size_t(key % (long long)buckets.size())].push_back(id);
+    count++;
+  }
+
+  // Removes and returns an id with the smallest key.
+  int pop() {
+    while (buckets[cur].empty())
+      cur = cur + 1 == buckets.size() ? 0 : cur + 1;
+    int id = buckets[cur].back();
+    buckets[cur].pop_back();
+    count--;
+    return id;
+  }
+
+  void clear() {
+    for (auto &b : buckets)
+      b.clear();
+    cur = 0;
+    count = 0;
+  }
+
+private:
+  std::vector<std::vector<int>> buckets;
+  size_t cur = 0;
+  size_t count = 0;
+};
@@ -0,0 +1,25 @@
+/*
+
+    Checked parsing of numeric command-line arguments for the tools in this
+   directory. std::stoi throws on "abc" and reads "8x" as 8; parseNumber
+   accepts only a whole base-10 number that fits the target type, so a
+   tool can print its usage instead.
+*/
+
+#pragma once
+#include <charconv>
+#include <string_view>
+#include <system_error>
+
+// Parses all of `text` into `value`; leaves `value` unchanged and returns
+// false if `text` is empty, has anything after the number or is out of
+// range for T.
+template <class T> inline bool parseNumber(std::string_view text, T &value) {
+  T parsed{};
+  const char *end = text.data() + text.size();
+  auto [last, ec] = std::from_chars(text.data(), end, parsed);
+  if (text.empty() || ec != std::errc() || last != end)
+    return false;
+  value = parsed;
+  return true;
+}
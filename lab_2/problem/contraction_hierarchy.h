@@ -0,0 +1,486 @@
+/*
+
+    Contraction hierarchy for repeated point-to-point queries on a static
+   house graph.
+
+    Build (offline):
+      Rooms are contracted one at a time in order of a lazily updated
+   priority: edge difference (shortcuts the contraction would add minus the
+   doors it removes) plus the number of already contracted neighbors, which
+   spreads contraction evenly over the map. Contracting v adds a shortcut
+   u -> w (cost c(u,v) + c(v,w), middle room v) unless a witness search, a
+   bounded Dijkstra from u that avoids v, finds a path to w at least as
+   cheap. Once the rooms left average more than kCoreDegree live doors they
+   form a dense core (the hubs of a scale-free map) where contraction only
+   multiplies shortcuts, so the core is left as is.
+
+    Query:
+      Bidirectional Dijkstra in which both sides only climb to higher-ranked
+   rooms: forward along up edges from the source, backward along down edges
+   from the destination. Inside the core every door counts as both up and
+   down, so the two searches meet there as in plain bidirectional Dijkstra.
+   Shortcuts on the result are unpacked through their middle rooms, so the
+   path is a plain room sequence for printPath.
+
+    Door costs are hop counts on unweighted graphs. Doors may be directed.
+*/
+
+#pragma once
+#include "algo.h"
+#include "csr.h"
+#include "indexed_heap.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <utility>
+#include <vector>
+
+// Witness searches stop after settling this many rooms (the cheaper limit
+// when only estimating a priority); a missed witness only costs an
+// unnecessary shortcut, never a wrong answer.
+constexpr int kWitnessSettleLimit = 500;
+constexpr int kSimulateSettleLimit = 50;
+
+// Contraction stops when the uncontracted rooms average more live doors
+// (in + out) than this. Rooms above it get an estimated priority instead of
+// a simulated contraction.
+constexpr int kCoreDegree = 32;
+
+struct CHStats {
+  double buildMs = 0;
+  long long shortcuts = 0;
+  int coreRooms = 0; // rooms left uncontracted
+  size_t indexBytes = 0;
+};
+
+class ContractionHierarchy {
+public:
+  // One hierarchy edge. For an up edge of u, `to` is ranked above u (or
+  // both are in the core); for a down edge of u, the door runs `to` -> u
+  // and `to` is ranked above u (or both are in the core).
+  struct Edge {
+    int to;
+    int cost;
+    int middle; // contracted room this shortcut bypasses, -1 for a door
+  };
+
+  ContractionHierarchy() = default;
+  explicit ContractionHierarchy(const CSRGraph &g) { build(g); }
+
+  void build(const CSRGraph &g);
+
+  // Shortest path src -> dest. `expanded` counts settled rooms on both
+  // sides, `cost` is the path cost.
+  SearchResult query(int src, int dest);
+
+  const CHStats &stats() const { return info; }
+  int size() const { return int(rank.size()); }
+
+private:
+  struct Contractor;
+
+  const Edge *findEdge(int from, int to) const;
+  void unpack(int from, const Edge &e, std::vector<int> &path) const;
+
+  std::vector<int> rank;
+  int coreStart = 0; // rooms ranked from here on are the core
+  std::vector<int> upOffsets{0}, downOffsets{0};
+  std::vector<Edge> up, down;
+  CHStats info;
+
+  // Query scratch, reused across calls.
+  IndexedHeap<long long> fwdOpen, bwdOpen;
+  std::vector<long long> fwdDist, bwdDist;
+  std::vector<int> fwdParent, bwdParent; // index into up / down
+  std::vector<uint32_t> fwdStamp, bwdStamp;
+  uint32_t epoch = 0;
+};
+
+// Working graph during the build. out / in hold only arcs between rooms
+// not yet contracted; contracting a room moves its arcs to `retired`.
+struct ContractionHierarchy::Contractor {
+  struct Arc {
+    int to, cost, middle;
+  };
+  std::vector<std::vector<Arc>> out, in;
+  std::vector<std::pair<int, Arc>> retired; // (from, arc)
+  std::vector<int> contractedNeighbors;
+  long long liveArcs = 0;
+
+  // Witness search state. target[w] == v marks the rooms v has doors to
+  // while v is being contracted.
+  IndexedHeap<long long> open;
+  std::vector<long long> dist;
+  std::vector<uint32_t> stamp;
+  std::vector<int> target;
+  uint32_t epoch = 0;
+
+  explicit Contractor(const CSRGraph &g)
+      : out(g.size()), in(g.size()), contractedNeighbors(g.size(), 0),
+        open(g.size()), dist(g.size()), stamp(g.size(), 0),
+        target(g.size(), -1) {
+    for (int u = 0; u < g.size(); u++)
+      for (int e = g.offsets[u]; e < g.offsets[u + 1]; e++)
+        if (g.targets[e] != u)
+          addArc(u, g.targets[e], g.cost(e), -1);
+  }
+
+  // Adds u -> v or lowers the cost of an existing one.
+  void addArc(int u, int v, int cost, int middle) {
+    for (Arc &a : out[u])
+      if (a.to == v) {
+        if (cost < a.cost) {
+          a = {v, cost, middle};
+          for (Arc &b : in[v])
+            if (b.to == u)
+              b = {u, cost, middle};
+        }
+        return;
+      }
+    out[u].push_back({v, cost, middle});
+    in[v].push_back({u, cost, middle});
+    liveArcs++;
+  }
+
+  // Cheapest distances from `source` avoiding `skip`, up to `limit`; stops
+  // early once all `targets` rooms marked for `skip` are settled.
+  void witnessSearch(int source, int skip, long long limit, int targets,
+                     int settleLimit) {
+    if (++epoch == 0) {
+      std::fill(stamp.begin(), stamp.end(), 0);
+      epoch = 1;
+    }
+    open.clear();
+    stamp[source] = epoch;
+    dist[source] = 0;
+    open.push(source, 0);
+    for (int settled = 0; !open.empty() && settled < settleLimit; settled++) {
+      int u = open.pop();
+      if (target[u] == skip && --targets == 0)
+        break;
+      for (const Arc &a : out[u]) {
+        if (a.to == skip)
+          continue;
+        long long cand = dist[u] + a.cost;
+        if (cand > limit || (stamp[a.to] == epoch && cand >= dist[a.to]))
+          continue;
+        stamp[a.to] = epoch;
+        dist[a.to] = cand;
+        open.pushOrDecrease(a.to, cand);
+      }
+    }
+  }
+
+  long long distanceTo(int v) const {
+    return stamp[v] == epoch ? dist[v] : std::numeric_limits<long long>::max();
+  }
+
+  // Shortcuts needed to contract v; adds them unless `simulate`.
+  int contract(int v, bool simulate) {
+    int added = 0;
+    int maxOut = 0;
+    for (const Arc &b : out[v]) {
+      maxOut = std::max(maxOut, b.cost);
+      target[b.to] = v;
+    }
+    for (const Arc &a : in[v]) {
+      int u = a.to;
+      // u itself is settled first; if it is a target it needs no witness.
+      witnessSearch(u, v, (long long)a.cost + maxOut,
+                    int(out[v].size()) + (target[u] == v),
+                    simulate ? kSimulateSettleLimit : kWitnessSettleLimit);
+      for (const Arc &b : out[v]) {
+        int w = b.to;
+        if (w == u)
+          continue;
+        long long via = (long long)a.cost + b.cost;
+        if (distanceTo(w) <= via)
+          continue;
+        added++;
+        if (!simulate)
+          addArc(u, w, int(via), v);
+      }
+    }
+    for (const Arc &b : out[v])
+      target[b.to] = -1;
+    return added;
+  }
+
+  int degree(int v) const { return int(out[v].size() + in[v].size()); }
+
+  int priority(int v) {
+    int d = degree(v);
+    if (d > kCoreDegree) // every in/out pair, without witnesses
+      return d * d / 4 - d + contractedNeighbors[v];
+    return contract(v, true) - d + contractedNeighbors[v];
+  }
+
+  // Takes v out of the working graph after its shortcuts are in.
+  void retire(int v) {
+    auto drop = [v](std::vector<Arc> &arcs) {
+      for (size_t i = 0; i < arcs.size(); i++)
+        if (arcs[i].to == v) {
+          arcs[i] = arcs.back();
+          arcs.pop_back();
+          return;
+        }
+    };
+    for (const Arc &a : out[v]) {
+      retired.push_back({v, a});
+      drop(in[a.to]);
+      contractedNeighbors[a.to]++;
+    }
+    for (const Arc &a : in[v]) {
+      retired.push_back({a.to, {v, a.cost, a.middle}});
+      drop(out[a.to]);
+      contractedNeighbors[a.to]++;
+    }
+    liveArcs -= degree(v);
+    out[v].clear();
+    out[v].shrink_to_fit();
+    in[v].clear();
+    in[v].shrink_to_fit();
+  }
+};
+
+inline void ContractionHierarchy::build(const CSRGraph &g) {
+  auto t0 = std::chrono::steady_clock::now();
+  int n = g.size();
+  Contractor c(g);
+  IndexedHeap<int> order(n);
+  for (int v = 0; v < n; v++)
+    order.push(v, c.priority(v));
+  rank.assign(n, 0);
+  long long shortcuts = 0;
+  int next = 0;
+  for (; !order.empty(); next++) {
+    if (c.liveArcs * 2 > (long long)kCoreDegree * (n - next))
+      break;
+    // Lazy update: a stale priority is refreshed and the room requeued if
+    // it no longer beats the runner-up.
+    int v = order.pop();
+    int p = c.priority(v);
+    if (!order.empty() && p > order.keyOf(order.top())) {
+      order.push(v, p);
+      next--;
+      continue;
+    }
+    shortcuts += c.contract(v, false);
+    c.retire(v);
+    rank[v] = next;
+  }
+  coreStart = next;
+  while (!order.empty())
+    rank[order.pop()] = next++;
+  // Whatever is still in the working graph joins the core arcs.
+  for (int u = 0; u < n; u++)
+    for (const auto &a : c.out[u])
+      c.retired.push_back({u, a});
+
+  // Split every arc by direction of rank into CSR up / down lists; core
+  // arcs go in both.
+  auto bothCore = [&](int u, int v) {
+    return rank[u] >= coreStart && rank[v] >= coreStart;
+  };
+  auto isUp = [&](int u, int v) { return rank[v] > rank[u] || bothCore(u, v); };
+  auto isDown = [&](int u, int v) {
+    return rank[v] < rank[u] || bothCore(u, v);
+  };
+  std::vector<int> upCount(n + 1, 0), downCount(n + 1, 0);
+  for (const auto &[u, a] : c.retired) {
+    upCount[u + 1] += isUp(u, a.to);
+    downCount[a.to + 1] += isDown(u, a.to);
+  }
+  for (int u = 0; u < n; u++) {
+    upCount[u + 1] += upCount[u];
+    downCount[u + 1] += downCount[u];
+  }
+  upOffsets = upCount;
+  downOffsets = downCount;
+  up.resize(upOffsets[n]);
+  down.resize(downOffsets[n]);
+  for (const auto &[u, a] : c.retired) {
+    if (isUp(u, a.to))
+      up[upCount[u]++] = {a.to, a.cost, a.middle};
+    if (isDown(u, a.to))
+      down[downCount[a.to]++] = {u, a.cost, a.middle};
+  }
+
+  fwdOpen = IndexedHeap<long long>(n);
+  bwdOpen = IndexedHeap<long long>(n);
+  fwdDist.assign(n, 0);
+  bwdDist.assign(n, 0);
+  fwdParent.assign(n, -1);
+  bwdParent.assign(n, -1);
+  fwdStamp.assign(n, 0);
+  bwdStamp.assign(n, 0);
+  epoch = 0;
+
+  info.shortcuts = shortcuts;
+  info.coreRooms = n - coreStart;
+  info.indexBytes = rank.size() * sizeof(int) +
+                    (upOffsets.size() + downOffsets.size()) * sizeof(int) +
+                    (up.size() + down.size()) * sizeof(Edge);
+  info.buildMs = std::chrono::duration<double, std::milli>(
+                     std::chrono::steady_clock::now() - t0)
+                     .count();
+}
+
+// Cheapest hierarchy edge from -> to. Its lower-ranked end stores it.
+inline const ContractionHierarchy::Edge *
+ContractionHierarchy::findEdge(int from, int to) const {
+  const Edge *best = nullptr;
+  if (rank[to] > rank[from]) {
+    for (int i = upOffsets[from]; i < upOffsets[from + 1]; i++)
+      if (up[i].to == to && (!best || up[i].cost < best->cost))
+        best = &up[i];
+  } else {
+    for (int i = downOffsets[to]; i < downOffsets[to + 1]; i++)
+      if (down[i].to == from && (!best || down[i].cost < best->cost))
+        best = &down[i];
+  }
+  return best;
+}
+
+// Appends the rooms after `from` along edge e, expanding shortcuts.
+inline void ContractionHierarchy::unpack(int from, const Edge &e,
+                                         std::vector<int> &path) const {
+  // Each entry is a hierarchy edge (a -> b, middle) still to be expanded.
+  struct Pending {
+    int a, b, middle;
+  };
+  std::vector<Pending> stack{{from, e.to, e.middle}};
+  while (!stack.empty()) {
+    Pending p = stack.back();
+    stack.pop_back();
+    if (p.middle == -1) {
+      path.push_back(p.b);
+      continue;
+    }
+    const Edge *second = findEdge(p.middle, p.b);
+    const Edge *first = findEdge(p.a, p.middle);
+    stack.push_back({p.middle, p.b, second->middle});
+    stack.push_back({p.a, p.middle, first->middle});
+  }
+}
+
+inline SearchResult ContractionHierarchy::query(int src, int dest) {
+  SearchResult r;
+  if (src < 0 || dest < 0 || src >= size() || dest >= size())
+    return r;
+  if (++epoch == 0) {
+    std::fill(fwdStamp.begin(), fwdStamp.end(), 0);
+    std::fill(bwdStamp.begin(), bwdStamp.end(), 0);
+    epoch = 1;
+  }
+  fwdOpen.clear();
+  bwdOpen.clear();
+  fwdStamp[src] = epoch;
+  fwdDist[src] = 0;
+  fwdParent[src] = -1;
+  fwdOpen.push(src, 0);
+  bwdStamp[dest] = epoch;
+  bwdDist[dest] = 0;
+  bwdParent[dest] = -1;
+  bwdOpen.push(dest, 0);
+  r.generated = 2;
+
+  const long long kInf = std::numeric_limits<long long>::max();
+  long long best = kInf;
+  int meet = -1;
+  // Settles one room on one side; both sides only move up in rank.
+  auto step = [&](IndexedHeap<long long> &open, std::vector<long long> &dist,
+                  std::vector<int> &parent, std::vector<uint32_t> &stamp,
+                  const std::vector<int> &offsets,
+                  const std::vector<Edge> &edges,
+                  const std::vector<long long> &otherDist,
+                  const std::vector<uint32_t> &otherStamp) {
+    int u = open.pop();
+    r.expanded++;
+    if (otherStamp[u] == epoch && dist[u] + otherDist[u] < best) {
+      best = dist[u] + otherDist[u];
+      meet = u;
+    }
+    for (int i = offsets[u]; i < offsets[u + 1]; i++) {
+      int v = edges[i].to;
+      long long cand = dist[u] + edges[i].cost;
+      if (stamp[v] == epoch && cand >= dist[v])
+        continue;
+      stamp[v] = epoch;
+      dist[v] = cand;
+      parent[v] = i;
+      open.pushOrDecrease(v, cand);
+      r.generated++;
+    }
+  };
+  while (true) {
+    long long f = fwdOpen.empty() ? kInf : fwdOpen.keyOf(fwdOpen.top());
+    long long b = bwdOpen.empty() ? kInf : bwdOpen.keyOf(bwdOpen.top());
+    if (std::min(f, b) >= best)
+      break;
+    r.peakFrontier = std::max(r.peakFrontier, fwdOpen.size() + bwdOpen.size());
+    if (f <= b)
+      step(fwdOpen, fwdDist, fwdParent, fwdStamp, upOffsets, up, bwdDist,
+           bwdStamp);
+    else
+      step(bwdOpen, bwdDist, bwdParent, bwdStamp, downOffsets, down, fwdDist,
+           fwdStamp);
+  }
+  if (meet == -1)
+    return r;
+
+  // Hierarchy edges src -> meet (recovered backwards) then meet -> dest.
+  std::vector<std::pair<int, int>> climb; // (from, index into up)
+  for (int u = meet; fwdParent[u] != -1;) {
+    int i = fwdParent[u];
+    int from = int(std::upper_bound(upOffsets.begin(), upOffsets.end(), i) -
+                   upOffsets.begin()) -
+               1;
+    climb.emplace_back(from, i);
+    u = from;
+  }
+  r.path.push_back(src);
+  for (auto it = climb.rbegin(); it != climb.rend(); ++it)
+    unpack(it->first, up[it->second], r.path);
+  for (int u = meet; bwdParent[u] != -1;) {
+    int i = bwdParent[u];
+    // Down edge i is stored at the lower room; the door runs u -> owner.
+    int owner = int(std::upper_bound(downOffsets.begin(), downOffsets.end(),
+                                     i) -
+                    downOffsets.begin()) -
+                1;
+    unpack(u, Edge{owner, down[i].cost, down[i].middle}, r.path);
+    u = owner;
+  }
+  r.found = true;
+  r.cost = best;
+  return r;
+}
+
+// Answers src -> dest on `ch`, building it for `g` first if it has not
+// been built, and prints the path with the build and query costs.
+inline void contractionHierarchy(const CSRGraph &g, ContractionHierarchy &ch,
+                                 int src, int dest,
+                                 std::ostream &out = std::cout) {
+  if (ch.size() != g.size())
+    ch.build(g);
+  auto t0 = std::chrono::steady_clock::now();
+  SearchResult r = ch.query(src, dest);
+  double us = std::chrono::duration<double, std::micro>(
+                  std::chrono::steady_clock::now() - t0)
+                  .count();
+  const CHStats &s = ch.stats();
+  out << "Build time: " << s.buildMs << " ms, index size: " << s.indexBytes
+      << " bytes (" << s.shortcuts << " shortcuts, " << s.coreRooms
+      << " core rooms)\n";
+  if (!r.found) {
+    out << "No path found\n";
+    return;
+  }
+  out << "Path: ";
+  printPath(g, r.path, out);
+  out << "Path cost: " << r.cost << "\n";
+  out << "Nodes settled: " << r.expanded << ", query time: " << us << " us\n";
+}
@@ -0,0 +1,237 @@
+/*
+
+    Compact graph core shared by every search in algo.h.
+
+    Room names are interned once into dense integer ids (0 .. V-1) and the
+   doors are stored in compressed-sparse-row form:
+
+      offsets      size V+1, neighbors of u are targets[offsets[u] ..
+   offsets[u+1])
+      targets      size E, neighbor ids in insertion order
+      weights      size E (door traversal cost of each target) or empty
+   when every door costs 1
+      heuristic    size V, estimated cost from each room to the goal (0 if
+   unknown)
+      nameOffsets  size V+1, name of u is nameChars[nameOffsets[u] ..
+   nameOffsets[u+1])
+      byName       size V, ids sorted by name, for id() lookups
+
+    Every array is an immutable Column: it either owns a vector built in
+   memory (CSRBuilder) or borrows a section of a mapped graph file
+   (graph_file.h), so a loaded map is searched in place without parsing.
+   Copies of a CSRGraph share their columns.
+*/
+
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+template <class T> class Column {
+public:
+  Column() = default;
+
+  explicit Column(std::vector<T> values) {
+    auto owned = std::make_shared<const std::vector<T>>(std::move(values));
+    ptr = owned->data();
+    len = owned->size();
+    keepAlive = std::move(owned);
+  }
+
+  // Borrows `n` elements at `p`; `owner` keeps the memory valid.
+  Column(const T *p, size_t n, std::shared_ptr<const void> owner)
+      : ptr(p), len(n), keepAlive(std::move(owner)) {}
+
+  const T &operator[](size_t i) const { return ptr[i]; }
+  const T *data() const { return ptr; }
+  const T *begin() const { return ptr; }
+  const T *end() const { return ptr + len; }
+  size_t size() const { return len; }
+
+private:
+  const T *ptr = nullptr;
+  size_t len = 0;
+  std::shared_ptr<const void> keepAlive;
+};
+
+struct CSRGraph {
+  Column<int> offsets{std::vector<int>{0}};
+  Column<int> targets;
+  Column<int> weights;
+  Column<int> heuristic;
+  Column<uint32_t> nameOffsets{std::vector<uint32_t>{0}};
+  Column<char> nameChars;
+  Column<int> byName;
+  int maxCost = 1; // largest door cost (1 when unweighted)
+
+  struct Neighbors {
+    const int *first, *last;
+    const int *begin() const { return first; }
+    const int *end() const { return last; }
+    int size() const { return int(last - first); }
+  };
+
+  int size() const { return int(offsets.size()) - 1; }
+  int edgeCount() const { return int(targets.size()); }
+  bool weighted() const { return weights.size() != 0; }
+
+  // Cost of door e, where e indexes targets (offsets[u] <= e <
+  // offsets[u+1]).
+  int cost(int e) const { return weights.size() ? weights[e] : 1; }
+
+  std::string_view name(int u) const {
+    return {nameChars.data() + nameOffsets[u],
+            nameOffsets[u + 1] - nameOffsets[u]};
+  }
+
+  // Returns the id of a room, or -1 if the room is not in the graph.
+  int id(std::string_view room) const {
+    auto it = std::lower_bound(
+        byName.begin(), byName.end(), room,
+        [this](int u, std::string_view key) { return name(u) < key; });
+    return it != byName.end() && name(*it) == room ? *it : -1;
+  }
+
+  Neighbors neighbors(int u) const {
+    return {targets.data() + offsets[u], targets.data() + offsets[u + 1]};
+  }
+};
+
+// Packs a name list into the nameOffsets / nameChars / byName columns.
+inline void setNames(CSRGraph &g, const std::vector<std::string> &names) {
+  std::vector<uint32_t> offsets{0};
+  std::string chars;
+  for (const std::string &name : names) {
+    chars += name;
+    offsets.push_back(uint32_t(chars.size()));
+  }
+  std::vector<int> byName(names.size());
+  for (size_t u = 0; u < names.size(); u++)
+    byName[u] = int(u);
+  std::sort(byName.begin(), byName.end(),
+            [&](int a, int b) { return names[a] < names[b]; });
+  g.nameOffsets = Column<uint32_t>(std::move(offsets));
+  g.nameChars = Column<char>(std::vector<char>(chars.begin(), chars.end()));
+  g.byName = Column<int>(std::move(byName));
+}
+
+// Packs directed doors between ids 0 .. names.size()-1 into a CSRGraph.
+// `weights` is either empty (unit doors) or parallel to `edges`. Counting
+// sort by source keeps each adjacency list in insertion order.
+inline CSRGraph packCSR(const std::vector<std::string> &names,
+                        const std::vector<std::pair<int, int>> &edges,
+                        std::vector<int> heuristic,
+                        const std::vector<int> &weights = {}) {
+  int n = int(names.size());
+  std::vector<int> offsets(n + 1, 0);
+  for (const auto &e : edges)
+    offsets[e.first + 1]++;
+  for (int u = 0; u < n; u++)
+    offsets[u + 1] += offsets[u];
+  std::vector<int> targets(edges.size());
+  std::vector<int> costs(weights.empty() ? 0 : edges.size());
+  std::vector<int> fill(offsets.begin(), offsets.end() - 1);
+  for (size_t i = 0; i < edges.size(); i++) {
+    int slot = fill[edges[i].first]++;
+    targets[slot] = edges[i].second;
+    if (!weights.empty())
+      costs[slot] = weights[i];
+  }
+
+  heuristic.resize(n, 0);
+  CSRGraph g;
+  g.offsets = Column<int>(std::move(offsets));
+  g.targets = Column<int>(std::move(targets));
+  if (!costs.empty()) {
+    g.maxCost = *std::max_element(costs.begin(), costs.end());
+    g.weights = Column<int>(std::move(costs));
+  }
+  g.heuristic = Column<int>(std::move(heuristic));
+  setNames(g, names);
+  return g;
+}
+
+// Same rooms and doors with a different heuristic table (e.g. for another
+// goal); the topology columns are shared, not copied.
+inline CSRGraph withHeuristic(const CSRGraph &g, std::vector<int> heuristic) {
+  CSRGraph h = g;
+  heuristic.resize(g.size(), 0);
+  h.heuristic = Column<int>(std::move(heuristic));
+  return h;
+}
+
+// Collects rooms and doors in any order, then packs them into a CSRGraph.
+class CSRBuilder {
+public:
+  int intern(const std::string &name) {
+    auto it = ids.find(name);
+    if (it != ids.end())
+      return it->second;
+    int u = int(names.size());
+    ids.emplace(name, u);
+    names.push_back(name);
+    heuristic.push_back(0);
+    return u;
+  }
+
+  // Directed door u -> v costing w; add both directions for an undirected
+  // door.
+  void addEdge(const std::string &u, const std::string &v, int w = 1) {
+    int a = intern(u);
+    int b = intern(v);
+    edges.emplace_back(a, b);
+    weights.push_back(w);
+    unit = unit && w == 1;
+  }
+
+  void setHeuristic(const std::string &node, int h) {
+    heuristic[intern(node)] = h;
+  }
+
+  CSRGraph build() {
+    CSRGraph g = packCSR(names, edges, std::move(heuristic),
+                         unit ? std::vector<int>() : weights);
+    *this = CSRBuilder();
+    return g;
+  }
+
+private:
+  std::unordered_map<std::string, int> ids;
+  std::vector<std::string> names;
+  std::vector<int> heuristic;
+  std::vector<std::pair<int, int>> edges;
+  std::vector<int> weights;
+  bool unit = true;
+};
+
+// Same rooms with every door reversed; neighbors(v) of the result lists the
+// rooms that have a door into v in the original graph.
+inline CSRGraph transpose(const CSRGraph &g) {
+  CSRGraph t = g;
+  int n = g.size();
+  std::vector<int> offsets(n + 1, 0);
+  for (int v : g.targets)
+    offsets[v + 1]++;
+  for (int u = 0; u < n; u++)
+    offsets[u + 1] += offsets[u];
+  std::vector<int> targets(g.targets.size());
+  std::vector<int> costs(g.weights.size());
+  std::vector<int> fill(offsets.begin(), offsets.end() - 1);
+  for (int u = 0; u < n; u++)
+    for (int e = g.offsets[u]; e < g.offsets[u + 1]; e++) {
+      int slot = fill[g.targets[e]]++;
+      targets[slot] = u;
+      if (g.weighted())
+        costs[slot] = g.weights[e];
+    }
+  t.offsets = Column<int>(std::move(offsets));
+  t.targets = Column<int>(std::move(targets));
+  if (g.weighted())
+    t.weights = Column<int>(std::move(costs));
+  return t;
+}
@@ -0,0 +1,288 @@
+/*
+
+    All-pairs hop distances by bit-parallel multi-source BFS.
+
+    Running BFS from every room one at a time walks the graph V times. A
+   sweep here runs a whole batch of sources at once (Then et al., "The More
+   the Merrier: Efficient Multi-Source Graph Traversal"): every room holds
+   one bit per source of the batch in three bit sets,
+
+      seen    sources that have reached the room
+      visit   sources that reached it on the last level (the frontier)
+      next    sources arriving on the level being built
+
+   and one level ORs each frontier room's visit bits into its neighbors'
+   next bits. A room's new sources are next & ~seen, and the level is
+   written for each of them. Each door is crossed once per level for the
+   whole batch instead of once per source.
+
+    A room stays on the frontier for every level at which some source of
+   the batch first reaches it, so the saving depends on the batch's sources
+   being close together: their waves then arrive within a few levels of
+   each other. Sources are therefore batched by growing a BFS ball from
+   each untaken room, not by id; on floor plans, where ids run along rows,
+   batching by id was slower than one BFS per room.
+
+    A batch is 64, 128, 256 or 512 sources: one to eight 64-bit words per
+   room. The word loops are plain C++ that the compiler vectorizes (SSE2
+   by default, AVX2 / AVX-512 with -march=native), so the wider batches pay
+   off when the target has the wider registers. Batches are independent and
+   run concurrently on a ThreadPool.
+
+    Distances are hop counts along g's doors (door costs are ignored), as
+   uint16_t with kNoRoute for unreachable pairs, so a table holds at most
+   65535 rooms and takes 2 * V * V bytes. Sources are numbered by column in
+   batch order, and entry (s, t) is stored at t * V + column[s]: a sweep
+   writes each room's distances from its batch of sources as one
+   contiguous run.
+
+    Distance file (next to the graph, e.g. input.dist):
+      DistanceFileHeader, then int32 column[V], then uint16 dist[V*V] in
+   the layout above. nodeCount / edgeCount must match the graph it is
+   loaded for.
+*/
+
+#pragma once
+#include "csr.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+constexpr uint16_t kNoRoute = std::numeric_limits<uint16_t>::max();
+constexpr int kMaxDistanceTableRooms = kNoRoute;
+
+struct DistanceTable {
+  int n = 0;
+  std::vector<int> column;    // column of each source room
+  std::vector<uint16_t> dist; // (s, t) at t * n + column[s]
+
+  bool empty() const { return n == 0; }
+
+  // Hops from s to t, or kNoRoute.
+  uint16_t at(int s, int t) const {
+    return dist[size_t(t) * n + column[s]];
+  }
+};
+
+// Rooms in batch order: each batch of `width` is grown as a BFS ball over
+// rooms not yet taken, from the first room not yet taken.
+inline std::vector<int> distanceSourceOrder(const CSRGraph &g, int width) {
+  int n = g.size();
+  std::vector<int> order;
+  order.reserve(n);
+  std::vector<char> taken(n, 0);
+  std::vector<int> queue;
+  for (int seed = 0; seed < n; seed++) {
+    if (taken[seed])
+      continue;
+    // One ball per pass; a ball that runs out of rooms before it is full
+    // is topped up from the next seed.
+    queue.assign(1, seed);
+    taken[seed] = 1;
+    for (size_t head = 0; head < queue.size(); head++) {
+      order.push_back(queue[head]);
+      if (order.size() % width == 0) {
+        for (size_t i = head + 1; i < queue.size(); i++)
+          taken[queue[i]] = 0; // queued but left for the next ball
+        queue.resize(head + 1);
+        break;
+      }
+      for (int v : g.neighbors(queue[head]))
+        if (!taken[v]) {
+          taken[v] = 1;
+          queue.push_back(v);
+        }
+    }
+  }
+  return order;
+}
+
+// One multi-source BFS from sources[base .. base + W*64) (clipped to the
+// graph), writing their columns of `table`.
+template <int W>
+inline void distanceSweep(const CSRGraph &g, const std::vector<int> &order,
+                          int base, DistanceTable &table) {
+  int n = g.size();
+  int sources = std::min(n - base, W * 64);
+  std::vector<uint64_t> seen(size_t(n) * W, 0), visit(size_t(n) * W, 0),
+      next(size_t(n) * W, 0);
+  std::vector<char> queued(n, 0);
+  std::vector<int> frontier, touched;
+  for (int i = 0; i < sources; i++) {
+    int s = order[base + i];
+    uint64_t bit = uint64_t(1) << (i & 63);
+    seen[size_t(s) * W + i / 64] |= bit;
+    visit[size_t(s) * W + i / 64] |= bit;
+    frontier.push_back(s);
+    table.dist[size_t(s) * n + base + i] = 0;
+  }
+  for (uint16_t level = 1; !frontier.empty(); level++) {
+    touched.clear();
+    for (int v : frontier) {
+      const uint64_t *fv = &visit[size_t(v) * W];
+      for (int w : g.neighbors(v)) {
+        if (!queued[w]) {
+          queued[w] = 1;
+          touched.push_back(w);
+        }
+        uint64_t *nw = &next[size_t(w) * W];
+        for (int k = 0; k < W; k++)
+          nw[k] |= fv[k];
+      }
+    }
+    for (int v : frontier)
+      std::fill_n(&visit[size_t(v) * W], W, 0);
+    frontier.clear();
+    for (int w : touched) {
+      queued[w] = 0;
+      uint64_t *nw = &next[size_t(w) * W], *sw = &seen[size_t(w) * W];
+      uint64_t *vw = &visit[size_t(w) * W];
+      uint64_t any = 0;
+      for (int k = 0; k < W; k++) {
+        vw[k] = nw[k] & ~sw[k];
+        sw[k] |= vw[k];
+        nw[k] = 0;
+        any |= vw[k];
+      }
+      if (!any)
+        continue;
+      frontier.push_back(w);
+      uint16_t *row = &table.dist[size_t(w) * n + base];
+      for (int k = 0; k < W; k++)
+        for (uint64_t b = vw[k]; b; b &= b - 1)
+          row[k * 64 + __builtin_ctzll(b)] = level;
+    }
+  }
+}
+
+// Hop distances between every pair of rooms, `sourcesPerSweep` (64, 128,
+// 256 or 512) sources per BFS sweep. Prints a message and returns an empty
+// table if the graph is too large or the width is not supported.
+inline DistanceTable buildDistanceTable(const CSRGraph &g, ThreadPool &pool,
+                                        int sourcesPerSweep = 256) {
+  DistanceTable table;
+  int n = g.size();
+  if (n > kMaxDistanceTableRooms) {
+    std::cout << "A distance table holds at most " << kMaxDistanceTableRooms
+              << " rooms; this graph has " << n << ".\n";
+    return table;
+  }
+  void (*sweep)(const CSRGraph &, const std::vector<int> &, int,
+                DistanceTable &) = nullptr;
+  switch (sourcesPerSweep) {
+  case 64:
+    sweep = distanceSweep<1>;
+    break;
+  case 128:
+    sweep = distanceSweep<2>;
+    break;
+  case 256:
+    sweep = distanceSweep<4>;
+    break;
+  case 512:
+    sweep = distanceSweep<8>;
+    break;
+  default:
+    std::cout << "Sources per sweep must be 64, 128, 256 or 512.\n";
+    return table;
+  }
+  std::vector<int> order = distanceSourceOrder(g, sourcesPerSweep);
+  table.n = n;
+  table.column.resize(n);
+  for (int i = 0; i < n; i++)
+    table.column[order[i]] = i;
+  table.dist.assign(size_t(n) * n, kNoRoute);
+  int sweeps = (n + sourcesPerSweep - 1) / sourcesPerSweep;
+  pool.parallelFor(sweeps, [&](int i) {
+    sweep(g, order, i * sourcesPerSweep, table);
+  });
+  return table;
+}
+
+constexpr char kDistanceFileMagic[8] = {'H', 'C', 'R', 'D',
+                                        'I', 'S', 'T', 'S'};
+constexpr uint32_t kDistanceFileVersion = 1;
+
+struct DistanceFileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t entryBytes; // sizeof(uint16_t)
+  uint64_t nodeCount;
+  uint64_t edgeCount;
+};
+
+inline bool writeDistanceFile(const DistanceTable &table, const CSRGraph &g,
+                              const std::string &filename) {
+  std::ofstream fout(filename, std::ios::binary);
+  if (!fout.is_open()) {
+    std::cout << "Could not open " << filename << " for writing.\n";
+    return false;
+  }
+  DistanceFileHeader hdr{};
+  std::memcpy(hdr.magic, kDistanceFileMagic, sizeof hdr.magic);
+  hdr.version = kDistanceFileVersion;
+  hdr.entryBytes = sizeof(uint16_t);
+  hdr.nodeCount = g.size();
+  hdr.edgeCount = g.edgeCount();
+  fout.write(reinterpret_cast<const char *>(&hdr), sizeof hdr);
+  fout.write(reinterpret_cast<const char *>(table.column.data()),
+             table.column.size() * sizeof(int));
+  fout.write(reinterpret_cast<const char *>(table.dist.data()),
+             table.dist.size() * sizeof(uint16_t));
+  if (!fout) {
+    std::cout << "Failed writing " << filename << ".\n";
+    return false;
+  }
+  return true;
+}
+
+// Reads a distance file built for `g`; fails if it was built for a graph
+// of a different size.
+inline bool readDistanceFile(const std::string &filename, const CSRGraph &g,
+                             DistanceTable &table) {
+  std::ifstream fin(filename, std::ios::binary);
+  if (!fin.is_open()) {
+    std::cout << "Could not open distance file " << filename << ".\n";
+    return false;
+  }
+  DistanceFileHeader hdr{};
+  if (!fin.read(reinterpret_cast<char *>(&hdr), sizeof hdr) ||
+      std::memcmp(hdr.magic, kDistanceFileMagic, sizeof hdr.magic) != 0 ||
+      hdr.version != kDistanceFileVersion ||
+      hdr.entryBytes != sizeof(uint16_t)) {
+    std::cout << "Distance file " << filename
+              << " has an unknown format or version.\n";
+    return false;
+  }
+  if (hdr.nodeCount != uint64_t(g.size()) ||
+      hdr.edgeCount != uint64_t(g.edgeCount())) {
+    std::cout << "Distance file " << filename
+              << " was built for a different graph.\n";
+    return false;
+  }
+  DistanceTable in;
+  in.n = g.size();
+  in.column.resize(in.n);
+  in.dist.resize(size_t(in.n) * in.n);
+  fin.read(reinterpret_cast<char *>(in.column.data()),
+           in.column.size() * sizeof(int));
+  fin.read(reinterpret_cast<char *>(in.dist.data()),
+           in.dist.size() * sizeof(uint16_t));
+  if (!fin) {
+    std::cout << "Distance file " << filename << " is truncated.\n";
+    return false;
+  }
+  for (int c : in.column)
+    if (c < 0 || c >= in.n) {
+      std::cout << "Distance file " << filename << " is corrupt.\n";
+      return false;
+    }
+  table = std::move(in);
+  return true;
+}
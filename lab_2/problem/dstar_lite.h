@@ -0,0 +1,429 @@
+/*
+
+    Doors that open and close while the robot moves, and D* Lite to keep the
+   route up to date.
+
+    DynamicGraph copies the rooms and doors of a CSRGraph into per-room door
+   lists, out and in, so a door can be added, re-priced or removed in
+   O(degree). Doors are directed like the CSR ones; an undirected door is a
+   pair. Parallel doors between the same two rooms collapse to the cheapest.
+
+    DStarLite searches backwards from the goal and keeps, per room, g (the
+   settled cost to the goal) and rhs (the one-step lookahead from the
+   successors' g). After a door change only the rooms whose rhs no longer
+   matches their g are queued again, so a repair usually touches a small
+   neighborhood of the change instead of the whole map. The robot may move
+   between plans (moveTo); the key modifier km keeps queued keys valid
+   without re-sorting the queue.
+
+    Every door must cost at least 1. With free doors two rooms can keep
+   vouching for each other's stale cost after the way out between them
+   closes, and the repair never notices.
+
+    Keys use h(start, s) from ALT landmarks when given, 0 otherwise. Landmark
+   bounds stay admissible and consistent while doors only close or get
+   dearer. The first door that opens or gets cheaper drops them: the queue is
+   re-keyed once with h = 0 and planning continues from the same state.
+
+    Usage:
+      DynamicGraph doors(house);
+      DStarLite planner(doors, start, goal);
+      planner.plan();
+      int old = doors.removeDoor(u, v);
+      planner.doorChanged(u, v, old);
+      planner.plan(); // expanded / touched count only the repair
+*/
+
+#pragma once
+#include "algo.h"
+#include "csr.h"
+#include "indexed_heap.h"
+#include "landmarks.h"
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+class DynamicGraph {
+public:
+  struct Door {
+    int room; // the other end: target in successors(), source in
+              // predecessors()
+    int cost;
+  };
+
+  explicit DynamicGraph(const CSRGraph &g)
+      : rooms(g), out(g.size()), in(g.size()) {
+    for (int u = 0; u < g.size(); u++)
+      for (int e = g.offsets[u]; e < g.offsets[u + 1]; e++) {
+        int old = doorCost(u, g.targets[e]);
+        if (old == -1 || g.cost(e) < old)
+          setDoor(u, g.targets[e], g.cost(e));
+      }
+  }
+
+  int size() const { return int(out.size()); }
+  std::string_view name(int u) const { return rooms.name(u); }
+  int id(std::string_view room) const { return rooms.id(room); }
+  long long doorCount() const { return doors; }
+
+  const std::vector<Door> &successors(int u) const { return out[u]; }
+  const std::vector<Door> &predecessors(int v) const { return in[v]; }
+
+  // Cost of door u -> v, or -1 if there is none.
+  int doorCost(int u, int v) const {
+    for (const Door &d : out[u])
+      if (d.room == v)
+        return d.cost;
+    return -1;
+  }
+
+  // Opens door u -> v at `cost`, or re-prices it if it is already open.
+  // Returns the previous cost, -1 if the door was closed.
+  int setDoor(int u, int v, int cost) {
+    Door *d = find(out[u], v);
+    if (!d) {
+      out[u].push_back({v, cost});
+      in[v].push_back({u, cost});
+      doors++;
+      return -1;
+    }
+    int old = d->cost;
+    d->cost = cost;
+    find(in[v], u)->cost = cost;
+    return old;
+  }
+
+  // Closes door u -> v. Returns its cost, -1 if there was no such door.
+  int removeDoor(int u, int v) {
+    Door *d = find(out[u], v);
+    if (!d)
+      return -1;
+    int old = d->cost;
+    erase(out[u], d);
+    erase(in[v], find(in[v], u));
+    doors--;
+    return old;
+  }
+
+private:
+  CSRGraph rooms; // names only; the doors live in out / in
+  std::vector<std::vector<Door>> out, in;
+  long long doors = 0;
+
+  static Door *find(std::vector<Door> &list, int room) {
+    for (Door &d : list)
+      if (d.room == room)
+        return &d;
+    return nullptr;
+  }
+
+  static void erase(std::vector<Door> &list, Door *d) {
+    *d = list.back();
+    list.pop_back();
+  }
+};
+
+struct ReplanResult : SearchResult {
+  long long touched = 0; // rooms whose g or rhs changed since the last plan
+};
+
+class DStarLite {
+public:
+  // `bounds`, if given, must be landmarks of the map `g` was built from.
+  DStarLite(const DynamicGraph &g, int start, int goal,
+            const LandmarkIndex *bounds = nullptr)
+      : g(g), bounds(bounds && !bounds->empty() ? bounds : nullptr),
+        startRoom(start), goalRoom(goal), lastStart(start),
+        dist(g.size(), kInf), rhs(g.size(), kInf), open(g.size()),
+        stamp(g.size(), 0) {
+    if (start < 0 || goal < 0)
+      return;
+    rhs[goal] = 0;
+    touch(goal);
+    open.push(goal, key(goal));
+    generated = 1;
+  }
+
+  int start() const { return startRoom; }
+  int goal() const { return goalRoom; }
+  const DynamicGraph &graph() const { return g; }
+  // The landmarks in use; nullptr once a cheaper door has dropped them.
+  const LandmarkIndex *heuristic() const { return bounds; }
+
+  // The robot is now in `room`, normally the next room of the last path.
+  void moveTo(int room) { startRoom = room; }
+
+  // Door u -> v now costs g.doorCost(u, v) (-1: closed); it cost `oldCost`
+  // (-1: it did not exist). Call once per changed door, then plan().
+  void doorChanged(int u, int v, int oldCost) {
+    if (startRoom < 0 || goalRoom < 0)
+      return;
+    long long before = oldCost < 0 ? kInf : oldCost;
+    int now = g.doorCost(u, v);
+    long long after = now < 0 ? kInf : now;
+    if (after < before && bounds)
+      dropBounds();
+    followStart();
+    if (u == goalRoom)
+      return;
+    long long old = rhs[u];
+    if (before > after)
+      rhs[u] = std::min(rhs[u], add(dist[v], after));
+    else if (rhs[u] == add(dist[v], before))
+      rhs[u] = lookahead(u);
+    if (rhs[u] != old)
+      touch(u);
+    updateVertex(u);
+  }
+
+  // Brings the plan up to date and returns the path from start() with the
+  // work done since the previous call.
+  ReplanResult plan() {
+    ReplanResult r;
+    if (startRoom < 0 || goalRoom < 0)
+      return r;
+    followStart();
+    computeShortestPath(r);
+    r.generated = generated;
+    r.touched = touched;
+    generated = touched = 0;
+    if (++epoch == 0) {
+      std::fill(stamp.begin(), stamp.end(), 0);
+      epoch = 1;
+    }
+    if (rhs[startRoom] == kInf)
+      return r;
+    // Follow the cheapest door to a settled room until the goal. The start
+    // itself may be left with rhs < g; its successors are settled.
+    r.path.push_back(startRoom);
+    r.cost = 0;
+    for (int u = startRoom; u != goalRoom;) {
+      int next = -1;
+      long long best = kInf, step = 0;
+      for (const DynamicGraph::Door &d : g.successors(u)) {
+        long long c = add(dist[d.room], d.cost);
+        if (c < best) {
+          best = c;
+          next = d.room;
+          step = d.cost;
+        }
+      }
+      if (next == -1 || r.path.size() > size_t(g.size()))
+        return r; // only if some door costs 0
+      r.cost += step;
+      r.path.push_back(next);
+      u = next;
+    }
+    r.found = true;
+    return r;
+  }
+
+private:
+  using Key = std::pair<long long, long long>;
+  static constexpr long long kInf = std::numeric_limits<long long>::max() / 4;
+
+  const DynamicGraph &g;
+  const LandmarkIndex *bounds;
+  int startRoom, goalRoom, lastStart;
+  long long km = 0;
+  std::vector<long long> dist, rhs; // g and rhs of the paper
+  IndexedHeap<Key> open;
+  // Rooms touched since the last plan are stamped with the current epoch.
+  std::vector<uint32_t> stamp;
+  uint32_t epoch = 1;
+  long long touched = 0, generated = 0; // since the last plan
+
+  static long long add(long long a, long long c) {
+    return a == kInf || c == kInf ? kInf : a + c;
+  }
+
+  long long h(int a, int b) const {
+    return bounds ? bounds->lowerBound(a, b) : 0;
+  }
+
+  Key key(int s) const {
+    long long m = std::min(dist[s], rhs[s]);
+    if (m == kInf)
+      return {kInf, kInf};
+    return {m + h(startRoom, s) + km, m};
+  }
+
+  void touch(int s) {
+    if (stamp[s] != epoch) {
+      stamp[s] = epoch;
+      touched++;
+    }
+  }
+
+  long long lookahead(int s) const {
+    long long best = kInf;
+    for (const DynamicGraph::Door &d : g.successors(s))
+      best = std::min(best, add(dist[d.room], d.cost));
+    return best;
+  }
+
+  void updateVertex(int s) {
+    if (dist[s] != rhs[s]) {
+      if (open.contains(s)) {
+        open.update(s, key(s));
+      } else {
+        open.push(s, key(s));
+        generated++;
+      }
+    } else if (open.contains(s)) {
+      open.erase(s);
+    }
+  }
+
+  // Queued keys hold h from the start they were computed for; km grows by
+  // at most how far the robot has moved, which keeps them lower bounds.
+  void followStart() {
+    if (lastStart != startRoom) {
+      km += h(lastStart, startRoom);
+      lastStart = startRoom;
+    }
+  }
+
+  // h = 0 from here on: re-key every queued room once.
+  void dropBounds() {
+    bounds = nullptr;
+    km = 0;
+    lastStart = startRoom;
+    for (int s = 0; s < g.size(); s++)
+      if (open.contains(s))
+        open.update(s, key(s));
+  }
+
+  void computeShortestPath(ReplanResult &r) {
+    while (!open.empty() && (open.keyOf(open.top()) < key(startRoom) ||
+                             rhs[startRoom] > dist[startRoom])) {
+      r.peakFrontier = std::max(r.peakFrontier, open.size());
+      int u = open.top();
+      Key fresh = key(u);
+      if (open.keyOf(u) < fresh) {
+        open.update(u, fresh); // queued before km last grew
+        continue;
+      }
+      r.expanded++;
+      touch(u);
+      if (dist[u] > rhs[u]) {
+        dist[u] = rhs[u];
+        open.erase(u);
+        for (const DynamicGraph::Door &d : g.predecessors(u)) {
+          int s = d.room;
+          long long cand = add(dist[u], d.cost);
+          if (s != goalRoom && cand < rhs[s]) {
+            rhs[s] = cand;
+            touch(s);
+          }
+          updateVertex(s);
+        }
+      } else {
+        long long old = dist[u];
+        dist[u] = kInf;
+        for (const DynamicGraph::Door &d : g.predecessors(u)) {
+          int s = d.room;
+          if (s != goalRoom && rhs[s] == add(old, d.cost)) {
+            rhs[s] = lookahead(s);
+            touch(s);
+          }
+          updateVertex(s);
+        }
+        updateVertex(u);
+      }
+    }
+  }
+};
+
+// Repairs the plan and prints it, with the work the repair took next to
+// planning from scratch on the changed map. Returns the repaired plan.
+inline ReplanResult replan(DStarLite &planner, std::ostream &out = std::cout) {
+  ReplanResult r = planner.plan();
+  DStarLite fresh(planner.graph(), planner.start(), planner.goal(),
+                  planner.heuristic());
+  ReplanResult full = fresh.plan();
+  const DynamicGraph &g = planner.graph();
+  if (!r.found) {
+    out << "No path found\n";
+  } else {
+    out << "Path: ";
+    for (int u : r.path)
+      out << g.name(u) << " ";
+    out << "\nPath cost: " << r.cost << "\n";
+  }
+  out << "Nodes expanded: " << r.expanded << ", touched: " << r.touched
+      << " (full replan: " << full.expanded << " expanded, " << full.touched
+      << " touched)\n";
+  return r;
+}
+
+// Interactive door changes for the menu. Each line is one of
+//   close U V         closes the door between U and V (both directions)
+//   open U V [cost]   opens it, or changes its cost (default 1)
+//   move              the robot steps to the next room of its path
+//   done
+// and is followed by the repaired plan.
+inline void replanSession(const CSRGraph &house, int start, int goal,
+                          std::istream &in = std::cin,
+                          std::ostream &out = std::cout) {
+  if (start < 0 || goal < 0) {
+    out << "No path found\n";
+    return;
+  }
+  DynamicGraph doors(house);
+  DStarLite planner(doors, start, goal);
+  ReplanResult r = replan(planner, out);
+  std::string line;
+  while (true) {
+    out << "Door change (close U V, open U V [cost], move, done): ";
+    if (!std::getline(in >> std::ws, line))
+      return;
+    std::istringstream words(line);
+    std::string cmd, a, b;
+    int cost = 1;
+    words >> cmd >> a >> b;
+    if (cmd == "done")
+      return;
+    if (cmd == "move") {
+      if (r.found && r.path.size() > 1)
+        planner.moveTo(r.path[1]);
+      else
+        out << "Nowhere to move\n";
+    } else if (cmd == "close" || cmd == "open") {
+      int u = doors.id(a), v = doors.id(b);
+      if (u < 0 || v < 0) {
+        out << "Unknown room\n";
+        continue;
+      }
+      if (cmd == "open" && !(words >> cost))
+        cost = 1;
+      if (cost < 1) {
+        out << "Door costs must be at least 1\n";
+        continue;
+      }
+      bool changed = false;
+      for (auto [x, y] : {std::pair<int, int>{u, v}, {v, u}}) {
+        int old = cmd == "open" ? doors.setDoor(x, y, cost)
+                                : doors.removeDoor(x, y);
+        if (old != (cmd == "open" ? cost : -1)) {
+          planner.doorChanged(x, y, old);
+          changed = true;
+        }
+      }
+      if (!changed) {
+        out << "Nothing changed\n";
+        continue;
+      }
+    } else {
+      out << "Unknown command\n";
+      continue;
+    }
+    r = replan(planner, out);
+  }
+}
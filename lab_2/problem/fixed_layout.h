@@ -0,0 +1,291 @@
+/*
+
+    Compile-time house layouts and allocation-free searches over them.
+
+    A FixedLayout<V, E> is the CSR form of csr.h in std::array storage:
+   offsets, targets and the heuristic column, sized by template arguments,
+   with room names as string_views into the program image. makeFixedLayout
+   packs it from room and door lists in a constant expression, so a layout
+   that ships in firmware is built by the compiler, not at start-up.
+
+    fixedBFS, fixedDFS and fixedBestFirstSearch follow runBFS, runDFS and
+   runBestFirstSearch in algo.h (same visiting order and the same counters),
+   instantiated per layout size. Every queue, stack, heap, parent table and
+   visited set is a std::array or a bitset sized from V and E, so a query
+   never allocates and its worst case is fixed by the layout. All three are
+   constexpr: routes on a constexpr layout can be checked with
+   static_assert, and the same code runs as plain functions at run time.
+
+    Best-first ties on the heuristic go to the room queued first; the
+   priority_queue in runBestFirstSearch leaves their order to the library.
+*/
+
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+struct FixedDoor {
+  std::string_view from, to;
+};
+
+template <int V, int E> struct FixedLayout {
+  std::array<std::string_view, V> names{};
+  std::array<int, V + 1> offsets{};
+  std::array<int, E> targets{};
+  std::array<int, V> heuristic{};
+  bool valid = true; // false if a door names a room not in `names`
+
+  static constexpr int kRooms = V;
+  static constexpr int kDoors = E;
+
+  constexpr int size() const { return V; }
+
+  // Returns the id of a room, or -1 if the room is not in the layout.
+  constexpr int id(std::string_view room) const {
+    for (int u = 0; u < V; u++)
+      if (names[u] == room)
+        return u;
+    return -1;
+  }
+};
+
+// Rooms get ids in the order of `names`; doors are directed, as in csr.h,
+// and keep their order within each room.
+template <int V, int E>
+constexpr FixedLayout<V, E>
+makeFixedLayout(const std::array<std::string_view, V> &names,
+                const std::array<FixedDoor, E> &doors,
+                const std::array<int, V> &heuristic) {
+  FixedLayout<V, E> g;
+  g.names = names;
+  g.heuristic = heuristic;
+  std::array<int, E> from{}, to{};
+  for (int e = 0; e < E; e++) {
+    from[e] = g.id(doors[e].from);
+    to[e] = g.id(doors[e].to);
+    if (from[e] < 0 || to[e] < 0) {
+      g.valid = false;
+      return g;
+    }
+    g.offsets[from[e] + 1]++;
+  }
+  for (int u = 0; u < V; u++)
+    g.offsets[u + 1] += g.offsets[u];
+  std::array<int, V + 1> fill = g.offsets;
+  for (int e = 0; e < E; e++)
+    g.targets[fill[from[e]]++] = to[e];
+  return g;
+}
+
+// Visited set of N bits with constexpr access (std::bitset's setters are
+// not constexpr before C++23).
+template <int N> class FixedBits {
+public:
+  constexpr bool test(int i) const {
+    return (words[i >> 6] >> (i & 63)) & 1;
+  }
+  constexpr void set(int i) { words[i >> 6] |= uint64_t(1) << (i & 63); }
+
+private:
+  std::array<uint64_t, (N + 63) / 64> words{};
+};
+
+template <int V> struct FixedPath {
+  bool found = false;
+  std::array<int, V> rooms{}; // start .. goal in rooms[0 .. length)
+  int length = 0;
+  int expanded = 0;  // nodes taken off the frontier
+  int generated = 0; // nodes put on the frontier
+  int peakFrontier = 0;
+};
+
+// Follows parent links back from `goal` (tracePath for fixed storage).
+template <int V>
+constexpr void fixedTrace(const std::array<int, V> &parent, int goal,
+                          FixedPath<V> &r) {
+  r.found = true;
+  r.length = 0;
+  for (int u = goal; u != -1; u = parent[u])
+    r.rooms[r.length++] = u;
+  for (int i = 0, j = r.length - 1; i < j; i++, j--) {
+    int t = r.rooms[i];
+    r.rooms[i] = r.rooms[j];
+    r.rooms[j] = t;
+  }
+}
+
+template <int V, int E>
+constexpr FixedPath<V> fixedBFS(const FixedLayout<V, E> &g, int start,
+                                int goal) {
+  FixedPath<V> r;
+  if (start < 0 || goal < 0)
+    return r;
+  std::array<int, V> queue{}, parent{};
+  FixedBits<V> visited;
+  for (int &p : parent)
+    p = -1;
+  int head = 0, tail = 0;
+  queue[tail++] = start;
+  visited.set(start);
+  r.generated = 1;
+  while (head < tail) {
+    r.peakFrontier = std::max(r.peakFrontier, tail - head);
+    int curr = queue[head++];
+    r.expanded++;
+    if (curr == goal) {
+      fixedTrace<V>(parent, goal, r);
+      return r;
+    }
+    for (int e = g.offsets[curr]; e < g.offsets[curr + 1]; e++) {
+      int nbr = g.targets[e];
+      if (!visited.test(nbr)) {
+        visited.set(nbr);
+        parent[nbr] = curr;
+        queue[tail++] = nbr;
+        r.generated++;
+      }
+    }
+  }
+  return r;
+}
+
+template <int V, int E>
+constexpr FixedPath<V> fixedDFS(const FixedLayout<V, E> &g, int start,
+                                int goal) {
+  FixedPath<V> r;
+  if (start < 0 || goal < 0)
+    return r;
+  // Every door pushes at most once. (std::pair's assignment is not
+  // constexpr in C++17.)
+  struct Frame {
+    int node, from; // from: node it was pushed from
+  };
+  std::array<Frame, E + 1> stk{};
+  std::array<int, V> parent{};
+  FixedBits<V> visited;
+  for (int &p : parent)
+    p = -1;
+  int top = 0;
+  stk[top++] = {start, -1};
+  r.generated = 1;
+  while (top > 0) {
+    r.peakFrontier = std::max(r.peakFrontier, top);
+    auto [curr, from] = stk[--top];
+    r.expanded++;
+    if (curr == goal) {
+      parent[curr] = from;
+      fixedTrace<V>(parent, goal, r);
+      return r;
+    }
+    if (visited.test(curr))
+      continue;
+    visited.set(curr);
+    parent[curr] = from;
+    for (int e = g.offsets[curr]; e < g.offsets[curr + 1]; e++) {
+      int nbr = g.targets[e];
+      if (!visited.test(nbr)) {
+        stk[top++] = {nbr, curr};
+        r.generated++;
+      }
+    }
+  }
+  return r;
+}
+
+template <int V, int E>
+constexpr FixedPath<V> fixedBestFirstSearch(const FixedLayout<V, E> &g,
+                                            int start, int goal) {
+  FixedPath<V> r;
+  if (start < 0 || goal < 0)
+    return r;
+  // Binary min-heap on (heuristic, push order); every door pushes at most
+  // once.
+  struct Entry {
+    int h, seq, node, parent;
+    constexpr bool operator<(const Entry &o) const {
+      return h != o.h ? h < o.h : seq < o.seq;
+    }
+  };
+  std::array<Entry, E + 1> heap{};
+  int size = 0, seq = 0;
+  auto push = [&](const Entry &x) {
+    int i = size++;
+    while (i > 0 && x < heap[(i - 1) / 2]) {
+      heap[i] = heap[(i - 1) / 2];
+      i = (i - 1) / 2;
+    }
+    heap[i] = x;
+  };
+  auto pop = [&]() {
+    Entry top = heap[0];
+    Entry last = heap[--size];
+    int i = 0;
+    while (2 * i + 1 < size) {
+      int c = 2 * i + 1;
+      if (c + 1 < size && heap[c + 1] < heap[c])
+        c++;
+      if (!(heap[c] < last))
+        break;
+      heap[i] = heap[c];
+      i = c;
+    }
+    heap[i] = last;
+    return top;
+  };
+
+  std::array<int, V> parent{};
+  FixedBits<V> visited;
+  for (int &p : parent)
+    p = -1;
+  push({g.heuristic[start], seq++, start, -1});
+  r.generated = 1;
+  while (size > 0) {
+    r.peakFrontier = std::max(r.peakFrontier, size);
+    Entry current = pop();
+    if (visited.test(current.node))
+      continue;
+    visited.set(current.node);
+    parent[current.node] = current.parent;
+    r.expanded++;
+    if (current.node == goal) {
+      fixedTrace<V>(parent, goal, r);
+      return r;
+    }
+    for (int e = g.offsets[current.node]; e < g.offsets[current.node + 1];
+         e++) {
+      int nbr = g.targets[e];
+      if (!visited.test(nbr)) {
+        push({g.heuristic[nbr], seq++, nbr, current.node});
+        r.generated++;
+      }
+    }
+  }
+  return r;
+}
+
+// The house of input.txt, rooms in the order loadGraph interns them.
+inline constexpr FixedLayout<5, 14> kHouseLayout = makeFixedLayout<5, 14>(
+    {"X", "K", "L", "B", "Y"},
+    {{{"X", "K"},
+      {"X", "L"},
+      {"K", "X"},
+      {"K", "L"},
+      {"K", "B"},
+      {"L", "X"},
+      {"L", "K"},
+      {"L", "B"},
+      {"L", "Y"},
+      {"B", "K"},
+      {"B", "L"},
+      {"B", "Y"},
+      {"Y", "L"},
+      {"Y", "B"}}},
+    {5, 3, 2, 1, 0});
+
+static_assert(kHouseLayout.valid, "kHouseLayout names an unknown room");
+// Routes from X to Y, worked out by the compiler.
+static_assert(fixedBFS(kHouseLayout, 0, 4).length == 3);
+static_assert(fixedDFS(kHouseLayout, 0, 4).found);
+static_assert(fixedBestFirstSearch(kHouseLayout, 0, 4).length == 3);
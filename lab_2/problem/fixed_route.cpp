@@ -0,0 +1,44 @@
+// Routing queries on the compiled-in house layout (fixed_layout.h).
+//
+//   g++ -O2 -std=c++17 fixed_route.cpp -o fixed_route
+//   echo "X Y bfs" | ./fixed_route
+//
+// Each input line is "source destination [bfs|dfs|bestfirst]" by room
+// name (bfs by default). The layout and every search buffer are fixed-size,
+// so answering a query allocates nothing; only reading the line does.
+#include "fixed_layout.h"
+#include <iostream>
+#include <sstream>
+#include <string>
+
+int main() {
+  constexpr const auto &house = kHouseLayout;
+  std::string line;
+  while (std::getline(std::cin, line)) {
+    std::istringstream words(line);
+    std::string src, dest, algo = "bfs";
+    if (!(words >> src >> dest))
+      continue;
+    words >> algo;
+    int s = house.id(src), t = house.id(dest);
+    FixedPath<house.kRooms> r;
+    if (algo == "bfs")
+      r = fixedBFS(house, s, t);
+    else if (algo == "dfs")
+      r = fixedDFS(house, s, t);
+    else if (algo == "bestfirst")
+      r = fixedBestFirstSearch(house, s, t);
+    else {
+      std::cout << "Unknown algorithm " << algo << "\n";
+      continue;
+    }
+    if (!r.found) {
+      std::cout << "No path found\n";
+      continue;
+    }
+    for (int i = 0; i < r.length; i++)
+      std::cout << house.names[r.rooms[i]] << " ";
+    std::cout << "(expanded " << r.expanded << ")\n";
+  }
+  return 0;
+}
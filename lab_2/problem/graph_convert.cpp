@@ -0,0 +1,33 @@
+// Converts a text house graph (input.txt format) into the binary graph file
+// read by mapGraphFile, and optionally builds an ALT landmark file for it.
+//
+//   g++ -O2 -std=c++17 -pthread graph_convert.cpp -o graph_convert
+//   ./graph_convert input.txt input.bin [input.lmk [landmarks]]
+#include "cli_args.h"
+#include "graph_file.h"
+#include "landmarks.h"
+#include <iostream>
+#include <string>
+
+int main(int argc, char **argv) {
+  int k = 16; // landmarks
+  bool countOk = argc != 5 || (parseNumber(argv[4], k) && k >= 1);
+  if (argc < 3 || argc > 5 || !countOk) {
+    std::cout << "Usage: " << argv[0]
+              << " <input.txt> <output.bin> [landmarks.lmk [count]]\n";
+    return 1;
+  }
+  CSRGraph g;
+  if (!readTextGraph(argv[1], g) || !writeGraphFile(g, argv[2]))
+    return 1;
+  std::cout << "Wrote " << argv[2] << ": " << g.size() << " rooms, "
+            << g.edgeCount() << " doors\n";
+  if (argc >= 4) {
+    ThreadPool pool;
+    LandmarkIndex idx = buildLandmarks(g, k, pool);
+    if (!writeLandmarkFile(idx, g, argv[3]))
+      return 1;
+    std::cout << "Wrote " << argv[3] << ": " << idx.k << " landmarks\n";
+  }
+  return 0;
+}
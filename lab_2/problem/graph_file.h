@@ -0,0 +1,314 @@
+/*
+
+    Loading and saving house graphs.
+
+    Text format (input.txt):
+      E            number of doors, then E lines "u v" or "u v cost"
+   (directed u -> v; a door without a cost costs 1)
+      V            number of heuristic entries, then V lines "room h"
+
+    Binary format (written by graph_convert, read with mapGraphFile):
+      GraphFileHeader, then 8-byte aligned sections holding the CSRGraph
+   columns exactly as they sit in memory (host byte order):
+
+      offsets      int32[V+1]
+      targets      int32[E]
+      heuristic    int32[V]
+      nameOffsets  uint32[V+1]
+      byName       int32[V]
+      nameChars    char[nameBytes]
+      weights      int32[E], only for weighted graphs (version 2; the
+   section offset is 0 when every door costs 1)
+
+    mapGraphFile mmaps the file read-only and points the graph's columns at
+   the sections, so loading costs a header check instead of a parse.
+*/
+
+#pragma once
+#include "csr.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+constexpr char kGraphFileMagic[8] = {'H', 'C', 'R', 'G', 'R', 'A', 'P', 'H'};
+constexpr uint32_t kGraphFileVersion = 2;
+// Version 1 files (no weights section) are still read.
+constexpr uint32_t kGraphFileByteOrder = 0x01020304;
+
+enum GraphSection {
+  kOffsets,
+  kTargets,
+  kHeuristic,
+  kNameOffsets,
+  kByName,
+  kNameChars,
+  kWeights,
+  kSectionCount
+};
+
+constexpr int kGraphFileV1Sections = kWeights;
+
+struct GraphFileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t byteOrder;
+  uint64_t nodeCount;
+  uint64_t edgeCount;
+  uint64_t nameBytes;
+  uint64_t section[kSectionCount]; // file offset of each section
+};
+
+// Parses the text format into `g`. Room names may be any whitespace-free
+// token, not just single characters.
+inline bool readTextGraph(const std::string &filename, CSRGraph &g) {
+  std::ifstream fin(filename, std::ios::binary);
+  if (!fin.is_open()) {
+    std::cout << "Could not open input file.\n";
+    return false;
+  }
+  std::string text((std::istreambuf_iterator<char>(fin)),
+                   std::istreambuf_iterator<char>());
+  const char *p = text.data(), *end = p + text.size();
+  auto token = [&]() -> std::string_view {
+    while (p < end && std::isspace((unsigned char)*p))
+      p++;
+    const char *start = p;
+    while (p < end && !std::isspace((unsigned char)*p))
+      p++;
+    return {start, size_t(p - start)};
+  };
+  auto number = [&](long long &value) {
+    std::string_view t = token();
+    auto [last, ec] = std::from_chars(t.data(), t.data() + t.size(), value);
+    return ec == std::errc() && !t.empty() && last == t.data() + t.size();
+  };
+  // True if the current line has another token before its end.
+  auto moreOnLine = [&]() {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+      p++;
+    return p < end && *p != '\n';
+  };
+
+  CSRBuilder b;
+  long long edges, nodes, h, cost;
+  if (!number(edges)) {
+    std::cout << "Malformed input file: missing edge count.\n";
+    return false;
+  }
+  for (long long i = 0; i < edges; i++) {
+    std::string_view u = token(), v = token();
+    if (v.empty()) {
+      std::cout << "Malformed input file: truncated edge list.\n";
+      return false;
+    }
+    cost = 1;
+    if (moreOnLine() && (!number(cost) || cost < 0 || cost > INT32_MAX)) {
+      std::cout << "Malformed input file: bad door cost.\n";
+      return false;
+    }
+    b.addEdge(std::string(u), std::string(v), int(cost));
+  }
+  if (!number(nodes))
+    nodes = 0;
+  for (long long i = 0; i < nodes; i++) {
+    std::string_view node = token();
+    if (!number(h)) {
+      std::cout << "Malformed input file: truncated heuristic list.\n";
+      return false;
+    }
+    b.setHeuristic(std::string(node), int(h));
+  }
+  g = b.build();
+  return true;
+}
+
+inline bool writeGraphFile(const CSRGraph &g, const std::string &filename) {
+  std::ofstream fout(filename, std::ios::binary);
+  if (!fout.is_open()) {
+    std::cout << "Could not open " << filename << " for writing.\n";
+    return false;
+  }
+  GraphFileHeader hdr{};
+  std::memcpy(hdr.magic, kGraphFileMagic, sizeof hdr.magic);
+  hdr.version = kGraphFileVersion;
+  hdr.byteOrder = kGraphFileByteOrder;
+  hdr.nodeCount = g.size();
+  hdr.edgeCount = g.edgeCount();
+  hdr.nameBytes = g.nameChars.size();
+
+  const void *data[kSectionCount] = {
+      g.offsets.data(),     g.targets.data(), g.heuristic.data(),
+      g.nameOffsets.data(), g.byName.data(),  g.nameChars.data(),
+      g.weights.data()};
+  uint64_t bytes[kSectionCount] = {
+      g.offsets.size() * sizeof(int),
+      g.targets.size() * sizeof(int),
+      g.heuristic.size() * sizeof(int),
+      g.nameOffsets.size() * sizeof(uint32_t),
+      g.byName.size() * sizeof(int),
+      g.nameChars.size(),
+      g.weights.size() * sizeof(int)};
+  uint64_t pos = sizeof hdr;
+  for (int s = 0; s < kSectionCount; s++) {
+    pos = (pos + 7) & ~uint64_t(7);
+    hdr.section[s] = pos;
+    pos += bytes[s];
+  }
+  if (!g.weighted())
+    hdr.section[kWeights] = 0;
+
+  fout.write(reinterpret_cast<const char *>(&hdr), sizeof hdr);
+  const char zeros[8] = {};
+  pos = sizeof hdr;
+  for (int s = 0; s < kSectionCount; s++) {
+    if (hdr.section[s] == 0)
+      continue;
+    fout.write(zeros, hdr.section[s] - pos);
+    fout.write(static_cast<const char *>(data[s]), bytes[s]);
+    pos = hdr.section[s] + bytes[s];
+  }
+  if (!fout) {
+    std::cout << "Failed writing " << filename << ".\n";
+    return false;
+  }
+  return true;
+}
+
+// Whether the columns of `g` describe a well-formed graph: offsets run
+// from 0 to E without decreasing, every door leads to a room, names lie
+// within nameChars and byName lists rooms in name order. One O(V+E) pass
+// over a mapped file, so a damaged one is rejected instead of being read
+// out of bounds by the searches.
+inline bool validGraphColumns(const CSRGraph &g) {
+  int v = g.size();
+  if (g.offsets[0] != 0 || g.offsets[v] != g.edgeCount() ||
+      g.nameOffsets[0] != 0 || g.nameOffsets[v] > g.nameChars.size())
+    return false;
+  for (int u = 0; u < v; u++)
+    if (g.offsets[u] > g.offsets[u + 1] ||
+        g.nameOffsets[u] > g.nameOffsets[u + 1])
+      return false;
+  for (int t : g.targets)
+    if (t < 0 || t >= v)
+      return false;
+  for (int i = 0; i < v; i++) {
+    int u = g.byName[i];
+    if (u < 0 || u >= v || (i > 0 && g.name(g.byName[i - 1]) > g.name(u)))
+      return false;
+  }
+  return true;
+}
+
+// Maps a binary graph file and points `g` at it. The mapping stays alive
+// as long as any copy of `g` (or of its columns) does.
+inline bool mapGraphFile(const std::string &filename, CSRGraph &g) {
+  int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    std::cout << "Could not open graph file " << filename << ".\n";
+    return false;
+  }
+  struct stat st;
+  if (::fstat(fd, &st) != 0 || size_t(st.st_size) < sizeof(GraphFileHeader)) {
+    ::close(fd);
+    std::cout << "Graph file " << filename << " is truncated.\n";
+    return false;
+  }
+  size_t fileSize = st.st_size;
+  void *base = ::mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (base == MAP_FAILED) {
+    std::cout << "Could not map graph file " << filename << ".\n";
+    return false;
+  }
+  std::shared_ptr<const void> mapping(base, [fileSize](const void *p) {
+    ::munmap(const_cast<void *>(p), fileSize);
+  });
+
+  const char *bytes = static_cast<const char *>(base);
+  const auto *hdr = reinterpret_cast<const GraphFileHeader *>(bytes);
+  if (std::memcmp(hdr->magic, kGraphFileMagic, sizeof hdr->magic) != 0 ||
+      hdr->version < 1 || hdr->version > kGraphFileVersion ||
+      hdr->byteOrder != kGraphFileByteOrder) {
+    std::cout << "Graph file " << filename
+              << " has an unknown format or version.\n";
+    return false;
+  }
+  uint64_t v = hdr->nodeCount, e = hdr->edgeCount;
+  // Room and door ids are ints and name offsets uint32_t.
+  if (v >= uint64_t(INT32_MAX) || e > uint64_t(INT32_MAX) ||
+      hdr->nameBytes > UINT32_MAX) {
+    std::cout << "Graph file " << filename << " is corrupt.\n";
+    return false;
+  }
+  // A version 1 header ends before section[kWeights].
+  bool weighted = hdr->version >= 2 && hdr->section[kWeights] != 0;
+  int sections = weighted ? kSectionCount : kGraphFileV1Sections;
+  uint64_t bytesOf[kSectionCount] = {(v + 1) * sizeof(int),
+                                     e * sizeof(int),
+                                     v * sizeof(int),
+                                     (v + 1) * sizeof(uint32_t),
+                                     v * sizeof(int),
+                                     hdr->nameBytes,
+                                     e * sizeof(int)};
+  for (int s = 0; s < sections; s++) {
+    if (hdr->section[s] % 8 != 0 || hdr->section[s] > fileSize ||
+        bytesOf[s] > fileSize - hdr->section[s]) {
+      std::cout << "Graph file " << filename << " is truncated.\n";
+      return false;
+    }
+  }
+  auto at = [&](int s) { return bytes + hdr->section[s]; };
+  g.offsets = Column<int>(reinterpret_cast<const int *>(at(kOffsets)), v + 1,
+                          mapping);
+  g.targets =
+      Column<int>(reinterpret_cast<const int *>(at(kTargets)), e, mapping);
+  g.weights = Column<int>();
+  g.maxCost = 1;
+  if (weighted) {
+    g.weights = Column<int>(reinterpret_cast<const int *>(at(kWeights)), e,
+                            mapping);
+    g.maxCost = 0;
+    for (int c : g.weights) {
+      if (c < 0) {
+        std::cout << "Graph file " << filename << " is corrupt.\n";
+        g = CSRGraph();
+        return false;
+      }
+      g.maxCost = std::max(g.maxCost, c);
+    }
+  }
+  g.heuristic =
+      Column<int>(reinterpret_cast<const int *>(at(kHeuristic)), v, mapping);
+  g.nameOffsets = Column<uint32_t>(
+      reinterpret_cast<const uint32_t *>(at(kNameOffsets)), v + 1, mapping);
+  g.byName =
+      Column<int>(reinterpret_cast<const int *>(at(kByName)), v, mapping);
+  g.nameChars = Column<char>(at(kNameChars), hdr->nameBytes, mapping);
+  if (!validGraphColumns(g)) {
+    std::cout << "Graph file " << filename << " is corrupt.\n";
+    g = CSRGraph();
+    return false;
+  }
+  return true;
+}
+
+// Loads a binary graph file if `filename` is one, otherwise the text format.
+inline bool loadGraph(const std::string &filename, CSRGraph &g) {
+  char magic[sizeof kGraphFileMagic] = {};
+  std::ifstream probe(filename, std::ios::binary);
+  if (probe.read(magic, sizeof magic) &&
+      std::memcmp(magic, kGraphFileMagic, sizeof magic) == 0)
+    return mapGraphFile(filename, g);
+  return readTextGraph(filename, g);
+}
@@ -0,0 +1,241 @@
+/*
+
+    Synthetic house graphs for benchmarking the searches in algo.h.
+
+    - gridFloorPlan:    rooms on a W x H grid; a random spanning tree of doors
+   keeps every room reachable, extra doors between neighboring cells are
+   added with probability `extraDoors`.
+    - randomGeometric:  rooms scattered in the unit square, a door between
+   every pair closer than the radius giving the requested average degree.
+    - treeWithBackEdges: random recursive tree plus doors back to an ancestor
+   (the j-b cycle of lab_1, at scale).
+    - scaleFree:        Barabasi-Albert preferential attachment, `m` doors
+   per new room.
+
+    All doors are undirected (stored in both directions) and rooms are named
+   R0 .. R(n-1). heuristicFor() gives a consistent heuristic for any goal:
+   grid and geometric layouts use their coordinates, the others use half the
+   true hop distance. withRandomCosts() prices the doors of any of them for
+   the weighted searches; hop-based heuristics stay admissible since every
+   door costs at least 1.
+*/
+
+#pragma once
+#include "csr.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct GeneratedGraph {
+  std::string kind;
+  CSRGraph g;
+  std::vector<std::pair<double, double>> coords; // empty without a layout
+  double radius = 1;                             // door length bound
+};
+
+inline std::vector<std::string> roomNames(int n) {
+  std::vector<std::string> names(n);
+  for (int i = 0; i < n; i++)
+    names[i] = "R" + std::to_string(i);
+  return names;
+}
+
+inline void addDoor(std::vector<std::pair<int, int>> &edges, int u, int v) {
+  edges.emplace_back(u, v);
+  edges.emplace_back(v, u);
+}
+
+inline GeneratedGraph gridFloorPlan(int width, int height, double extraDoors,
+                                    uint64_t seed) {
+  std::mt19937_64 rng(seed);
+  int n = width * height;
+  std::vector<std::pair<int, int>> walls;
+  for (int y = 0; y < height; y++)
+    for (int x = 0; x < width; x++) {
+      int u = y * width + x;
+      if (x + 1 < width)
+        walls.emplace_back(u, u + 1);
+      if (y + 1 < height)
+        walls.emplace_back(u, u + width);
+    }
+  std::shuffle(walls.begin(), walls.end(), rng);
+  // Randomized Kruskal: the first wall joining two components becomes a
+  // door; the rest become doors with probability extraDoors.
+  std::vector<int> root(n);
+  std::iota(root.begin(), root.end(), 0);
+  auto find = [&](int u) {
+    while (root[u] != u)
+      u = root[u] = root[root[u]];
+    return u;
+  };
+  std::bernoulli_distribution extra(extraDoors);
+  std::vector<std::pair<int, int>> edges;
+  for (auto [u, v] : walls) {
+    int a = find(u), b = find(v);
+    if (a != b) {
+      root[a] = b;
+      addDoor(edges, u, v);
+    } else if (extra(rng)) {
+      addDoor(edges, u, v);
+    }
+  }
+  GeneratedGraph out;
+  out.kind = "grid";
+  out.g = packCSR(roomNames(n), edges, {});
+  for (int u = 0; u < n; u++)
+    out.coords.emplace_back(u % width, u / width);
+  return out;
+}
+
+inline GeneratedGraph randomGeometric(int n, double avgDegree,
+                                      uint64_t seed) {
+  std::mt19937_64 rng(seed);
+  std::uniform_real_distribution<double> unit(0, 1);
+  GeneratedGraph out;
+  out.kind = "geometric";
+  for (int u = 0; u < n; u++)
+    out.coords.emplace_back(unit(rng), unit(rng));
+  double r = std::sqrt(avgDegree / (std::acos(-1.0) * n));
+  out.radius = r;
+  // Bucket rooms into r x r cells so only adjacent cells are compared.
+  int cells = std::max(1, int(1 / r));
+  std::vector<std::vector<int>> bucket(cells * cells);
+  auto cellOf = [&](double c) { return std::min(cells - 1, int(c * cells)); };
+  for (int u = 0; u < n; u++)
+    bucket[cellOf(out.coords[u].second) * cells + cellOf(out.coords[u].first)]
+        .push_back(u);
+  std::vector<std::pair<int, int>> edges;
+  for (int u = 0; u < n; u++) {
+    int cx = cellOf(out.coords[u].first), cy = cellOf(out.coords[u].second);
+    for (int y = std::max(0, cy - 1); y <= std::min(cells - 1, cy + 1); y++)
+      for (int x = std::max(0, cx - 1); x <= std::min(cells - 1, cx + 1); x++)
+        for (int v : bucket[y * cells + x]) {
+          double dx = out.coords[u].first - out.coords[v].first;
+          double dy = out.coords[u].second - out.coords[v].second;
+          if (v > u && dx * dx + dy * dy <= r * r)
+            addDoor(edges, u, v);
+        }
+  }
+  out.g = packCSR(roomNames(n), edges, {});
+  return out;
+}
+
+inline GeneratedGraph treeWithBackEdges(int n, double backEdges,
+                                        uint64_t seed) {
+  std::mt19937_64 rng(seed);
+  std::vector<int> parent(n, -1);
+  std::vector<std::pair<int, int>> edges;
+  for (int u = 1; u < n; u++) {
+    parent[u] = std::uniform_int_distribution<int>(0, u - 1)(rng);
+    addDoor(edges, parent[u], u);
+  }
+  std::bernoulli_distribution back(backEdges);
+  for (int u = 1; u < n; u++) {
+    if (!back(rng) || parent[u] <= 0)
+      continue;
+    // Link to an ancestor two or more levels up.
+    int a = parent[parent[u]];
+    int climb = std::uniform_int_distribution<int>(0, 4)(rng);
+    while (climb-- > 0 && parent[a] != -1)
+      a = parent[a];
+    addDoor(edges, u, a);
+  }
+  GeneratedGraph out;
+  out.kind = "tree";
+  out.g = packCSR(roomNames(n), edges, {});
+  return out;
+}
+
+inline GeneratedGraph scaleFree(int n, int m, uint64_t seed) {
+  std::mt19937_64 rng(seed);
+  std::vector<std::pair<int, int>> edges;
+  std::vector<int> endpoints; // each room once per door it has
+  int core = std::min(n, m + 1);
+  for (int u = 0; u < core; u++)
+    for (int v = u + 1; v < core; v++) {
+      addDoor(edges, u, v);
+      endpoints.push_back(u);
+      endpoints.push_back(v);
+    }
+  std::vector<int> picked;
+  for (int u = core; u < n; u++) {
+    picked.clear();
+    while ((int)picked.size() < m) {
+      int v = endpoints[std::uniform_int_distribution<size_t>(
+          0, endpoints.size() - 1)(rng)];
+      if (std::find(picked.begin(), picked.end(), v) == picked.end())
+        picked.push_back(v);
+    }
+    for (int v : picked) {
+      addDoor(edges, u, v);
+      endpoints.push_back(u);
+      endpoints.push_back(v);
+    }
+  }
+  GeneratedGraph out;
+  out.kind = "scalefree";
+  out.g = packCSR(roomNames(n), edges, {});
+  return out;
+}
+
+// g with each door costing 1..maxCost, picked by hashing the door and the
+// seed so both directions of a door agree. Topology and names are shared
+// with g.
+inline CSRGraph withRandomCosts(const CSRGraph &g, int maxCost,
+                                uint64_t seed) {
+  maxCost = std::max(1, maxCost);
+  std::vector<int> costs(g.edgeCount());
+  for (int u = 0; u < g.size(); u++)
+    for (int e = g.offsets[u]; e < g.offsets[u + 1]; e++) {
+      auto [a, b] = std::minmax(u, g.targets[e]);
+      // splitmix64 finalizer
+      uint64_t z = seed + (uint64_t(a) << 32 | uint32_t(b)) *
+                              0x9e3779b97f4a7c15ULL;
+      z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+      z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+      costs[e] = 1 + int((z ^ (z >> 31)) % uint64_t(maxCost));
+    }
+  CSRGraph h = g;
+  h.maxCost = costs.empty() ? 1 : *std::max_element(costs.begin(), costs.end());
+  h.weights = Column<int>(std::move(costs));
+  return h;
+}
+
+// Hop distance from `goal` to every room (-1 if unreachable). Doors are
+// undirected, so distances to and from the goal agree.
+inline std::vector<int> hopDistances(const CSRGraph &g, int goal) {
+  std::vector<int> dist(g.size(), -1), queue{goal};
+  dist[goal] = 0;
+  for (size_t head = 0; head < queue.size(); head++)
+    for (int v : g.neighbors(queue[head]))
+      if (dist[v] == -1) {
+        dist[v] = dist[queue[head]] + 1;
+        queue.push_back(v);
+      }
+  return dist;
+}
+
+// A heuristic that never drops by more than one across a door, so it is
+// consistent (and admissible) for hop counts.
+inline std::vector<int> heuristicFor(const GeneratedGraph &gg, int goal) {
+  int n = gg.g.size();
+  std::vector<int> h(n, 0);
+  if (!gg.coords.empty()) {
+    auto [gx, gy] = gg.coords[goal];
+    for (int u = 0; u < n; u++) {
+      double dx = gg.coords[u].first - gx, dy = gg.coords[u].second - gy;
+      h[u] = gg.kind == "grid" ? int(std::abs(dx) + std::abs(dy))
+                               : int(std::sqrt(dx * dx + dy * dy) / gg.radius);
+    }
+    return h;
+  }
+  std::vector<int> dist = hopDistances(gg.g, goal);
+  for (int u = 0; u < n; u++)
+    h[u] = dist[u] < 0 ? 0 : dist[u] / 2;
+  return h;
+}
@@ -1,3 +1,4 @@
+#include "csr.h"
 #include <iostream>
 #include <map>
 #include <ostream>
@@ -6,45 +7,46 @@
 #include <unordered_map>
 #include <vector>
 
-void helperFunction() { std::cout << "Helper function called\n"; }
+void helperFunction(std::ostream &out = std::cout) {
+  out << "Helper function called\n";
+}
 
-void printAdjacencyList(
-    const std::unordered_map<char, std::vector<char>> &adjlist) {
-  std::cout << "\nAdjacency List (ASCII):\n";
-  for (const auto &[node, neighbors] : adjlist) {
-    std::cout << node << " : ";
-    for (char nb : neighbors)
-      std::cout << nb << " ";
-    std::cout << "\n";
+void printAdjacencyList(const CSRGraph &g, std::ostream &out = std::cout) {
+  out << "\nAdjacency List (ASCII):\n";
+  for (int node = 0; node < g.size(); node++) {
+    out << g.name(node) << " : ";
+    for (int nb : g.neighbors(node))
+      out << g.name(nb) << " ";
+    out << "\n";
   }
 }
 
-void printEdgeList(const std::unordered_map<char, std::vector<char>> &adjlist) {
-  std::set<std::pair<char, char>> printed;
-  std::cout << "\nEdge List (ASCII):\n";
-  for (const auto &[node, neighbors] : adjlist) {
-    for (char nb : neighbors) {
+void printEdgeList(const CSRGraph &g, std::ostream &out = std::cout) {
+  std::set<std::pair<int, int>> printed;
+  out << "\nEdge List (ASCII):\n";
+  for (int node = 0; node < g.size(); node++) {
+    for (int nb : g.neighbors(node)) {
       auto e = std::minmax(node, nb);
       if (printed.count(e))
         continue;
-      std::cout << e.first << " --- " << e.second << "\n";
+      out << g.name(e.first) << " --- " << g.name(e.second) << "\n";
       printed.insert(e);
     }
   }
 }
 
-void printSimpleAsciiGraph(
-    const std::unordered_map<char, std::vector<char>> &adjlist) {
-  std::cout << "\nSimple ASCII Diagram:\n";
-  std::cout << "Nodes: ";
-  for (const auto &[node, _] : adjlist) {
-    std::cout << node << " ";
+void printSimpleAsciiGraph(const CSRGraph &g,
+                           std::ostream &out = std::cout) {
+  out << "\nSimple ASCII Diagram:\n";
+  out << "Nodes: ";
+  for (int node = 0; node < g.size(); node++) {
+    out << g.name(node) << " ";
   }
-  std::cout << "\nConnections:\n";
-  for (const auto &[node, neighbors] : adjlist) {
-    std::cout << node << ": ";
-    for (char nb : neighbors)
-      std::cout << "--" << nb << " ";
-    std::cout << "\n";
+  out << "\nConnections:\n";
+  for (int node = 0; node < g.size(); node++) {
+    out << g.name(node) << ": ";
+    for (int nb : g.neighbors(node))
+      out << "--" << g.name(nb) << " ";
+    out << "\n";
   }
 }
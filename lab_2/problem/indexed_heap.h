@@ -0,0 +1,141 @@
+/*
+
+    Indexed d-ary min-heap over node ids 0 .. n-1.
+
+    Each id is in the heap at most once; pos[] tracks where, so a better key
+   for a queued node is a decreaseKey instead of a duplicate entry. A wider
+   node (D = 4 by default) makes the tree shallower, which suits searches
+   that decrease keys far more often than they pop.
+*/
+
+#pragma once
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+template <class Key, int D = 4> class IndexedHeap {
+public:
+  explicit IndexedHeap(int n = 0) : pos(n, -1), key(n) {}
+
+  // Grows the id range to n if needed; existing entries are kept.
+  void resize(int n) {
+    if (n > (int)pos.size()) {
+      pos.resize(n, -1);
+      key.resize(n);
+    }
+  }
+
+  bool empty() const { return heap.empty(); }
+  size_t size() const { return heap.size(); }
+  bool contains(int id) const { return pos[id] != -1; }
+  const Key &keyOf(int id) const { return key[id]; }
+  int top() const { return heap[0]; }
+
+  void push(int id, const Key &k) {
+    key[id] = k;
+    pos[id] = int(heap.size());
+    heap.push_back(id);
+    siftUp(pos[id]);
+  }
+
+  // Lowers the key of a queued id; callers check the new key is smaller.
+  void decreaseKey(int id, const Key &k) {
+    key[id] = k;
+    siftUp(pos[id]);
+  }
+
+  // Inserts or decreases, whichever applies. Returns false if `k` is not
+  // an improvement on the queued key.
+  bool pushOrDecrease(int id, const Key &k) {
+    if (!contains(id)) {
+      push(id, k);
+      return true;
+    }
+    if (!(k < key[id]))
+      return false;
+    decreaseKey(id, k);
+    return true;
+  }
+
+  // Moves a queued id to key `k`, up or down.
+  void update(int id, const Key &k) {
+    key[id] = k;
+    siftUp(pos[id]);
+    siftDown(pos[id]);
+  }
+
+  // Removes a queued id.
+  void erase(int id) {
+    int i = pos[id];
+    pos[id] = -1;
+    int last = heap.back();
+    heap.pop_back();
+    if (i == int(heap.size()))
+      return;
+    heap[i] = last;
+    pos[last] = i;
+    siftUp(i);
+    siftDown(pos[last]);
+  }
+
+  int pop() {
+    int id = heap[0];
+    pos[id] = -1;
+    int last = heap.back();
+    heap.pop_back();
+    if (!heap.empty()) {
+      heap[0] = last;
+      pos[last] = 0;
+      siftDown(0);
+    }
+    return id;
+  }
+
+  // Empties the heap in O(size), leaving the id range allocated.
+  void clear() {
+    for (int id : heap)
+      pos[id] = -1;
+    heap.clear();
+  }
+
+private:
+  void siftUp(int i) {
+    int id = heap[i];
+    while (i > 0) {
+      int parent = (i - 1) / D;
+      if (!(key[id] < key[heap[parent]]))
+        break;
+      heap[i] = heap[parent];
+      pos[heap[i]] = i;
+      i = parent;
+    }
+    heap[i] = id;
+    pos[id] = i;
+  }
+
+  void siftDown(int i) {
+    int id = heap[i];
+    int n = int(heap.size());
+    while (true) {
+      int first = i * D + 1;
+      if (first >= n)
+        break;
+      int best = first;
+      int last = std::min(first + D, n);
+      for (int c = first + 1; c < last; c++)
+        if (key[heap[c]] < key[heap[best]])
+          best = c;
+      if (!(key[heap[best]] < key[id]))
+        break;
+      heap[i] = heap[best];
+      pos[heap[i]] = i;
+      i = best;
+    }
+    heap[i] = id;
+    pos[id] = i;
+  }
+
+  std::vector<int> heap;
+  std::vector<int> pos;
+  std::vector<Key> key;
+};
@@ -0,0 +1,303 @@
+/*
+
+    Measured cost of a search, reported as JSON lines.
+
+    The printers in algo.h state each algorithm's textbook complexity; this
+   file measures what one run actually cost. Any search whose result has the
+   SearchResult counters (every run* function in this project) can be run
+   under a SearchProbe, which fills a SearchMetrics with:
+
+      cost                door costs along the path found; unknown for
+   searches that do not add them up (BFS, DFS, best-first, ...)
+      ms                  wall time (steady clock); inflated by anything
+   else running on the same cores
+      expanded, generated, peak_frontier
+                          the search's own counters
+      allocated_bytes     bytes requested from operator new by the calling
+   thread during the run
+      peak_heap_bytes     most heap held at once during the run by the
+   calling thread, above what it held when the run started
+      cycles, instructions, cache_misses, branch_misses
+                          hardware counters from perf_event_open(2) for the
+   calling thread, when asked for and when the kernel allows it
+
+    Heap use is counted per thread, so searches measured on different
+   threads at the same time do not see each other's allocations. A block is
+   charged to the thread that allocates it and credited to the thread that
+   frees it; memory a search's pool workers allocate is not counted.
+
+    The heap figures need operator new / delete replaced, which a program
+   may do once: define INSTRUMENT_HEAP before the first include of this file
+   in the program's one translation unit. Without it they are reported as
+   unknown, as are hardware counters the kernel refuses (containers and
+   perf_event_paranoid > 2 usually refuse them all) or that are not asked
+   for. Unknown values are -1 in SearchMetrics and null in JSON.
+
+    writeJsonLine writes a SearchMetrics as one JSON object on one line;
+   writeMetricsFields writes the same fields for callers that add their own.
+*/
+
+#pragma once
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+struct SearchMetrics {
+  std::string algorithm;
+  bool found = false;
+  size_t pathLength = 0;
+  long long cost = -1;
+  double ms = 0;
+  long long expanded = 0;
+  long long generated = 0;
+  size_t peakFrontier = 0;
+  long long allocatedBytes = -1;
+  long long peakHeapBytes = -1;
+  long long cycles = -1;
+  long long instructions = -1;
+  long long cacheMisses = -1;
+  long long branchMisses = -1;
+};
+
+// Heap accounting kept by the INSTRUMENT_HEAP operator new / delete, for
+// the calling thread.
+inline thread_local long long threadAllocatedBytes = 0;
+inline thread_local long long threadLiveBytes = 0;
+inline thread_local long long threadPeakBytes = 0;
+
+#ifdef INSTRUMENT_HEAP
+constexpr bool kHeapCounted = true;
+
+void *operator new(size_t size) {
+  // 16-byte header keeps the block's size for operator delete.
+  void *p = std::malloc(size + 16);
+  if (!p)
+    throw std::bad_alloc();
+  *static_cast<size_t *>(p) = size;
+  threadAllocatedBytes += (long long)size;
+  threadLiveBytes += (long long)size;
+  threadPeakBytes = std::max(threadPeakBytes, threadLiveBytes);
+  return static_cast<char *>(p) + 16;
+}
+
+// Not inlined: GCC otherwise sees the header arithmetic against the
+// caller's object and reports false -Warray-bounds / -Wmismatched-new-delete.
+[[gnu::noinline]] void operator delete(void *p) noexcept {
+  if (!p)
+    return;
+  char *block = static_cast<char *>(p) - 16;
+  threadLiveBytes -= (long long)*reinterpret_cast<size_t *>(block);
+  std::free(block);
+}
+
+void operator delete(void *p, size_t) noexcept { operator delete(p); }
+void *operator new[](size_t size) { return operator new(size); }
+void operator delete[](void *p) noexcept { operator delete(p); }
+void operator delete[](void *p, size_t) noexcept { operator delete(p); }
+#else
+constexpr bool kHeapCounted = false;
+#endif
+
+// Cycles, instructions, cache misses and branch misses of the calling
+// thread, counted in user space as one perf event group. Events the kernel
+// will not open read as -1; elsewhere than Linux all of them do.
+class PerfCounters {
+public:
+  static constexpr int kEvents = 4;
+
+  PerfCounters() {
+#if defined(__linux__)
+    const uint64_t configs[kEvents] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+    for (int i = 0; i < kEvents; i++) {
+      perf_event_attr attr{};
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.size = sizeof(attr);
+      attr.config = configs[i];
+      attr.disabled = leader() < 0; // the group starts with its leader
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                         PERF_FORMAT_TOTAL_TIME_RUNNING;
+      fds[i] = int(syscall(SYS_perf_event_open, &attr, 0, -1, leader(), 0));
+      if (fds[i] >= 0)
+        opened++;
+      else if (i == 0)
+        break; // no group to join
+    }
+#endif
+  }
+  PerfCounters(const PerfCounters &) = delete;
+  PerfCounters &operator=(const PerfCounters &) = delete;
+  ~PerfCounters() {
+#if defined(__linux__)
+    for (int fd : fds)
+      if (fd >= 0)
+        ::close(fd);
+#endif
+  }
+
+  bool available() const { return opened > 0; }
+
+  void start() {
+#if defined(__linux__)
+    if (leader() < 0)
+      return;
+    ioctl(leader(), PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(leader(), PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+  }
+
+  // Stops the group and returns its counts in constructor order, scaled up
+  // if the kernel had to multiplex the counters.
+  std::array<long long, kEvents> stop() {
+    std::array<long long, kEvents> counts;
+    counts.fill(-1);
+#if defined(__linux__)
+    if (leader() < 0)
+      return counts;
+    ioctl(leader(), PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    // nr, time enabled, time running, then one value per open event.
+    uint64_t buf[3 + kEvents];
+    ssize_t n = ::read(leader(), buf, sizeof(buf));
+    if (n < ssize_t(3 * sizeof(uint64_t)) || buf[0] != uint64_t(opened) ||
+        buf[2] == 0)
+      return counts;
+    double scale = double(buf[1]) / double(buf[2]);
+    for (int i = 0, v = 3; i < kEvents; i++)
+      if (fds[i] >= 0)
+        counts[i] = (long long)(double(buf[v++]) * scale);
+#endif
+    return counts;
+  }
+
+private:
+  std::array<int, kEvents> fds{{-1, -1, -1, -1}};
+  int opened = 0;
+
+  int leader() const { return fds[0]; }
+};
+
+// Measures one run at a time. Reuse a probe for repeated runs: opening the
+// hardware counters costs a few system calls.
+class SearchProbe {
+public:
+  explicit SearchProbe(bool hardware = false)
+      : perf(hardware ? std::make_unique<PerfCounters>() : nullptr) {}
+
+  void start() {
+    allocatedBefore = threadAllocatedBytes;
+    liveBefore = threadLiveBytes;
+    threadPeakBytes = liveBefore;
+    if (perf)
+      perf->start();
+    t0 = std::chrono::steady_clock::now();
+  }
+
+  // Ends the run started by start(); `r` is what the search returned.
+  template <class Result>
+  SearchMetrics stop(const std::string &algorithm, const Result &r) {
+    auto t1 = std::chrono::steady_clock::now();
+    SearchMetrics m;
+    if (perf) {
+      std::array<long long, PerfCounters::kEvents> c = perf->stop();
+      m.cycles = c[0];
+      m.instructions = c[1];
+      m.cacheMisses = c[2];
+      m.branchMisses = c[3];
+    }
+    m.ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+    if (kHeapCounted) {
+      m.allocatedBytes = threadAllocatedBytes - allocatedBefore;
+      m.peakHeapBytes = threadPeakBytes - liveBefore;
+    }
+    m.algorithm = algorithm;
+    m.found = r.found;
+    m.pathLength = r.path.size();
+    m.cost = r.found ? r.cost : -1;
+    m.expanded = r.expanded;
+    m.generated = r.generated;
+    m.peakFrontier = r.peakFrontier;
+    return m;
+  }
+
+private:
+  std::unique_ptr<PerfCounters> perf;
+  std::chrono::steady_clock::time_point t0;
+  long long allocatedBefore = 0, liveBefore = 0;
+};
+
+// Runs `run()` once under a fresh probe, stores its metrics in `m` and
+// returns what it returned.
+template <class F>
+auto measureSearch(const std::string &algorithm, F &&run, SearchMetrics &m,
+                   bool hardware = false) -> decltype(run()) {
+  SearchProbe probe(hardware);
+  probe.start();
+  auto r = run();
+  m = probe.stop(algorithm, r);
+  return r;
+}
+
+inline void writeJsonString(std::string_view s, std::ostream &out) {
+  out << '"';
+  for (unsigned char c : s) {
+    if (c == '"' || c == '\\')
+      out << '\\' << c;
+    else if (c == '\n')
+      out << "\\n";
+    else if (c < 0x20)
+      out << "\\u00" << "0123456789abcdef"[c >> 4]
+          << "0123456789abcdef"[c & 15];
+    else
+      out << char(c);
+  }
+  out << '"';
+}
+
+// The fields of `m`, comma-separated, without the enclosing braces.
+inline void writeMetricsFields(const SearchMetrics &m, std::ostream &out) {
+  auto count = [&](const char *name, long long v) {
+    out << ", \"" << name << "\": ";
+    if (v < 0)
+      out << "null";
+    else
+      out << v;
+  };
+  out << "\"algorithm\": ";
+  writeJsonString(m.algorithm, out);
+  out << ", \"found\": " << (m.found ? "true" : "false")
+      << ", \"path_length\": " << m.pathLength;
+  count("cost", m.cost);
+  out << ", \"ms\": " << m.ms << ", \"expanded\": " << m.expanded
+      << ", \"generated\": " << m.generated
+      << ", \"peak_frontier\": " << m.peakFrontier;
+  count("allocated_bytes", m.allocatedBytes);
+  count("peak_heap_bytes", m.peakHeapBytes);
+  count("cycles", m.cycles);
+  count("instructions", m.instructions);
+  count("cache_misses", m.cacheMisses);
+  count("branch_misses", m.branchMisses);
+}
+
+inline void writeJsonLine(const SearchMetrics &m, std::ostream &out) {
+  out << "{";
+  writeMetricsFields(m, out);
+  out << "}\n";
+}
@@ -0,0 +1,248 @@
+/*
+
+    ALT (A*, landmarks, triangle inequality) lower bounds for any goal.
+
+    A handful of landmark rooms are chosen far apart, and shortest-path
+   distances to and from each of them are tabulated once. For any rooms u
+   and t and any landmark L the triangle inequality gives
+
+      d(u, t) >= d(L, t) - d(L, u)      d(u, t) >= d(u, L) - d(t, L)
+
+   so the largest of these is an admissible heuristic for every goal, where
+   the heuristic column in input.txt only holds for Y. It is consistent
+   across every door between rooms that can reach the goal, so A* never
+   re-expands those.
+
+    Tables are node-major (all landmarks of room u are adjacent), so one
+   lower bound reads two short contiguous rows. Distances are hop counts on
+   unweighted graphs and door costs otherwise.
+
+    Landmark file (next to the graph, e.g. input.lmk):
+      LandmarkFileHeader, then int32 landmarks[k], uint32 from[V*k],
+   uint32 to[V*k]. nodeCount / edgeCount must match the graph it is loaded
+   for.
+*/
+
+#pragma once
+#include "csr.h"
+#include "indexed_heap.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <string>
+#include <vector>
+
+constexpr uint32_t kUnreachable = UINT32_MAX;
+
+// Shortest distance from `source` to every room along g's doors
+// (kUnreachable if none): BFS on unit doors, Dijkstra otherwise.
+inline std::vector<uint32_t> shortestDistances(const CSRGraph &g,
+                                               int source) {
+  std::vector<uint32_t> dist(g.size(), kUnreachable);
+  dist[source] = 0;
+  if (!g.weighted()) {
+    std::vector<int> queue{source};
+    for (size_t head = 0; head < queue.size(); head++)
+      for (int v : g.neighbors(queue[head]))
+        if (dist[v] == kUnreachable) {
+          dist[v] = dist[queue[head]] + 1;
+          queue.push_back(v);
+        }
+    return dist;
+  }
+  IndexedHeap<long long> open(g.size());
+  std::vector<long long> best(g.size(), -1);
+  std::vector<char> done(g.size(), 0);
+  best[source] = 0;
+  open.push(source, 0);
+  while (!open.empty()) {
+    int u = open.pop();
+    done[u] = 1;
+    dist[u] = uint32_t(std::min<long long>(best[u], kUnreachable - 1));
+    for (int e = g.offsets[u]; e < g.offsets[u + 1]; e++) {
+      int v = g.targets[e];
+      long long cand = best[u] + g.cost(e);
+      if (done[v] || (best[v] != -1 && cand >= best[v]))
+        continue;
+      best[v] = cand;
+      open.pushOrDecrease(v, cand);
+    }
+  }
+  return dist;
+}
+
+struct LandmarkIndex {
+  int k = 0;
+  std::vector<int> landmarks;
+  std::vector<uint32_t> from; // from[u*k + i] = d(landmarks[i], u)
+  std::vector<uint32_t> to;   // to[u*k + i]   = d(u, landmarks[i])
+
+  bool empty() const { return k == 0; }
+
+  // Lower bound on d(u, t); 0 when no landmark reaches both.
+  int lowerBound(int u, int t) const {
+    const uint32_t *fu = &from[size_t(u) * k], *ft = &from[size_t(t) * k];
+    const uint32_t *tu = &to[size_t(u) * k], *tt = &to[size_t(t) * k];
+    long long best = 0;
+    for (int i = 0; i < k; i++) {
+      if (fu[i] != kUnreachable && ft[i] != kUnreachable)
+        best = std::max(best, (long long)ft[i] - fu[i]);
+      if (tu[i] != kUnreachable && tt[i] != kUnreachable)
+        best = std::max(best, (long long)tu[i] - tt[i]);
+    }
+    return int(best);
+  }
+};
+
+// Heuristic column for `goal`, for withHeuristic() and the heuristic
+// searches in algo.h.
+inline std::vector<int> landmarkHeuristic(const LandmarkIndex &idx, int n,
+                                          int goal) {
+  std::vector<int> h(n, 0);
+  if (!idx.empty())
+    for (int u = 0; u < n; u++)
+      h[u] = idx.lowerBound(u, goal);
+  return h;
+}
+
+// Picks k landmarks by farthest-point selection (each new landmark is the
+// room farthest from those already chosen, starting from the one farthest
+// from `seed`) and tabulates their distances. Choosing a landmark needs its
+// forward distances, so those run in turn; the reverse tables, over the
+// transpose, are computed on the pool as soon as each landmark is known.
+inline LandmarkIndex buildLandmarks(const CSRGraph &g, int k,
+                                    ThreadPool &pool, int seed = 0) {
+  LandmarkIndex idx;
+  int n = g.size();
+  if (n == 0 || k <= 0)
+    return idx;
+  k = std::min(k, n);
+  CSRGraph incoming = transpose(g);
+  std::vector<std::vector<uint32_t>> fromL, toL(k);
+  std::vector<std::future<void>> pending;
+  // Distance from the landmarks chosen so far; a room unreachable from all
+  // of them is the best next pick.
+  std::vector<uint32_t> nearest(n, kUnreachable);
+  std::vector<uint32_t> start = shortestDistances(g, seed);
+  int next = int(std::max_element(start.begin(), start.end(),
+                                  [](uint32_t a, uint32_t b) {
+                                    return (a == kUnreachable ? 0 : a) <
+                                           (b == kUnreachable ? 0 : b);
+                                  }) -
+                 start.begin());
+  for (int i = 0; i < k; i++) {
+    idx.landmarks.push_back(next);
+    pending.push_back(pool.submit([&incoming, &toL, i, next] {
+      toL[i] = shortestDistances(incoming, next);
+    }));
+    fromL.push_back(shortestDistances(g, next));
+    long long farthest = -1;
+    for (int u = 0; u < n; u++) {
+      nearest[u] = std::min(nearest[u], fromL.back()[u]);
+      bool chosen = std::find(idx.landmarks.begin(), idx.landmarks.end(),
+                              u) != idx.landmarks.end();
+      if (!chosen && (long long)nearest[u] > farthest) {
+        farthest = nearest[u];
+        next = u;
+      }
+    }
+  }
+  for (auto &f : pending)
+    f.get();
+
+  idx.k = k;
+  idx.from.resize(size_t(n) * k);
+  idx.to.resize(size_t(n) * k);
+  for (int u = 0; u < n; u++)
+    for (int i = 0; i < k; i++) {
+      idx.from[size_t(u) * k + i] = fromL[i][u];
+      idx.to[size_t(u) * k + i] = toL[i][u];
+    }
+  return idx;
+}
+
+constexpr char kLandmarkFileMagic[8] = {'H', 'C', 'R', 'L',
+                                        'M', 'A', 'R', 'K'};
+constexpr uint32_t kLandmarkFileVersion = 1;
+
+struct LandmarkFileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t k;
+  uint64_t nodeCount;
+  uint64_t edgeCount;
+};
+
+inline bool writeLandmarkFile(const LandmarkIndex &idx, const CSRGraph &g,
+                              const std::string &filename) {
+  std::ofstream fout(filename, std::ios::binary);
+  if (!fout.is_open()) {
+    std::cout << "Could not open " << filename << " for writing.\n";
+    return false;
+  }
+  LandmarkFileHeader hdr{};
+  std::memcpy(hdr.magic, kLandmarkFileMagic, sizeof hdr.magic);
+  hdr.version = kLandmarkFileVersion;
+  hdr.k = idx.k;
+  hdr.nodeCount = g.size();
+  hdr.edgeCount = g.edgeCount();
+  fout.write(reinterpret_cast<const char *>(&hdr), sizeof hdr);
+  fout.write(reinterpret_cast<const char *>(idx.landmarks.data()),
+             idx.landmarks.size() * sizeof(int));
+  fout.write(reinterpret_cast<const char *>(idx.from.data()),
+             idx.from.size() * sizeof(uint32_t));
+  fout.write(reinterpret_cast<const char *>(idx.to.data()),
+             idx.to.size() * sizeof(uint32_t));
+  if (!fout) {
+    std::cout << "Failed writing " << filename << ".\n";
+    return false;
+  }
+  return true;
+}
+
+// Reads a landmark file built for `g`; fails if it was built for a graph
+// of a different size.
+inline bool readLandmarkFile(const std::string &filename, const CSRGraph &g,
+                             LandmarkIndex &idx) {
+  std::ifstream fin(filename, std::ios::binary);
+  if (!fin.is_open()) {
+    std::cout << "Could not open landmark file " << filename << ".\n";
+    return false;
+  }
+  LandmarkFileHeader hdr{};
+  if (!fin.read(reinterpret_cast<char *>(&hdr), sizeof hdr) ||
+      std::memcmp(hdr.magic, kLandmarkFileMagic, sizeof hdr.magic) != 0 ||
+      hdr.version != kLandmarkFileVersion) {
+    std::cout << "Landmark file " << filename
+              << " has an unknown format or version.\n";
+    return false;
+  }
+  if (hdr.nodeCount != uint64_t(g.size()) ||
+      hdr.edgeCount != uint64_t(g.edgeCount()) ||
+      hdr.k > hdr.nodeCount) {
+    std::cout << "Landmark file " << filename
+              << " was built for a different graph.\n";
+    return false;
+  }
+  LandmarkIndex in;
+  in.k = hdr.k;
+  in.landmarks.resize(hdr.k);
+  in.from.resize(hdr.nodeCount * hdr.k);
+  in.to.resize(hdr.nodeCount * hdr.k);
+  fin.read(reinterpret_cast<char *>(in.landmarks.data()),
+           in.landmarks.size() * sizeof(int));
+  fin.read(reinterpret_cast<char *>(in.from.data()),
+           in.from.size() * sizeof(uint32_t));
+  fin.read(reinterpret_cast<char *>(in.to.data()),
+           in.to.size() * sizeof(uint32_t));
+  if (!fin) {
+    std::cout << "Landmark file " << filename << " is truncated.\n";
+    return false;
+  }
+  idx = std::move(in);
+  return true;
+}
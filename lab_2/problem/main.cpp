@@ -1,9 +1,18 @@
+// Run ALL reports the heap use of each search (instrument.h).
+#define INSTRUMENT_HEAP
 #include "algo.h"
+#include "contraction_hierarchy.h"
+#include "dstar_lite.h"
+#include "graph_file.h"
+#include "output.h"
+#include "parallel_bfs.h"
+#include "stepped_search.h"
 #include "helper.cpp"
 #include <algorithm>
 #include <fstream>
 #include <functional>
 #include <iostream>
+#include <limits>
 #include <map>
 #include <queue>
 #include <set>
@@ -13,55 +22,43 @@
 #include <unordered_set>
 #include <vector>
 
-void input(graph &g, std::string filename) {
-  std::ifstream fin(filename);
-  if (!fin.is_open()) {
-    std::cout << "Could not open input file.\n";
-    return;
-  }
-  int edges;
-  fin >> edges;
-  for (int i = 0; i < edges; i++) {
-    char u, v;
-    fin >> u >> v;
-    g.adjlist[u].push_back(v);
-    if (g.adjlist.find(v) == g.adjlist.end()) {
-      g.adjlist[v] = {};
-    }
-  }
-  int nodes;
-  fin >> nodes;
-  for (int i = 0; i < nodes; i++) {
-    char node;
-    int h;
-    fin >> node >> h;
-    g.heuristic[node] = h;
-  }
-  fin.close();
-}
-
 int main() {
-  graph G;
-  input(G, "input.txt");
+  // Everything printed goes out in 64 KiB blocks; reading a menu choice
+  // flushes the prompt first.
+  BufferedStdout stdoutBuffer;
 
-  printAdjacencyList(G.adjlist);
-  printEdgeList(G.adjlist);
-  printSimpleAsciiGraph(G.adjlist);
+  // input.bin is the mapped binary form written by graph_convert; the text
+  // file is only parsed when no binary map is present.
+  CSRGraph house;
+  const char *houseFile =
+      std::ifstream("input.bin").good() ? "input.bin" : "input.txt";
+  if (!loadGraph(houseFile, house)) {
+    std::cout << "Could not load the house from " << houseFile << ".\n";
+    return 1;
+  }
+
+  printAdjacencyList(house);
+  printEdgeList(house);
+  printSimpleAsciiGraph(house);
 
-  std::map<std::string, std::vector<std::string>> adj = {
-      {"X", {"K", "L"}},
-      {"K", {"X", "L", "B"}},
-      {"L", {"X", "K", "B", "Y"}},
-      {"B", {"K", "L", "Y"}},
-      {"Y", {"L", "B"}}};
   std::string src = "X";
   std::string dest = "Y";
 
-  int beamwidth;
+  int beamwidth = 0;
   std::cout << "Enter beam width: ";
-  std::cin >> beamwidth;
+  while (!(std::cin >> beamwidth) || beamwidth < 1) {
+    if (std::cin.eof())
+      return 1;
+    std::cin.clear();
+    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    std::cout << "Beam width must be a positive number: ";
+  }
 
-  char hstart = 'X', hgoal = 'Y';
+  CSRGraph houseIn = transpose(house);
+  ThreadPool pool;
+  ContractionHierarchy hierarchy; // built on first use
+  int routes = kDefaultRoutes;    // k for K Shortest Paths and Run ALL
+  int s = house.id(src), d = house.id(dest);
 
   int ch;
   do {
@@ -72,68 +69,130 @@ int main() {
     std::cout << "6. British Museum (forward)\n7. British Museum (reverse)\n";
     std::cout << "8. Hill Climbing\n9. Beam Search\n10. Best First Search\n";
     std::cout << "11. Run ALL algorithms\n12. Helper Function\n13. Save output "
-                 "to output.txt\n14. Exit\nChoice: ";
+                 "to output.txt\n14. Exit\n";
+    std::cout << "15. Direction-optimizing BFS\n16. Parallel BFS\n";
+    std::cout << "17. Parallel Bidirectional BFS\n18. A* Search\n";
+    std::cout << "19. IDA* Search\n20. Contraction Hierarchy\n";
+    std::cout << "21. Dijkstra\n22. K Shortest Paths\n";
+    std::cout << "23. D* Lite (doors open and close)\n";
+    std::cout << "24. Anytime A* (expansions per tick)\nChoice: ";
     std::cin >> ch;
     switch (ch) {
     case 1:
-      bfs(src, dest, adj, false);
+      bfs(house, s, d, false);
       break;
     case 2:
-      bfs(src, dest, adj, true);
+      bfs(house, s, d, true);
       break;
     case 3:
-      biBFS(src, dest, adj);
+      biBFS(house, s, d);
       break;
     case 4:
-      dfs(src, dest, adj, false);
+      dfs(house, s, d, false);
       break;
     case 5:
-      dfs(src, dest, adj, true);
+      dfs(house, s, d, true);
       break;
     case 6:
-      britishMuseum(src, adj, dest, false);
+      britishMuseum(house, s, d, false);
       break;
     case 7:
-      britishMuseum(src, adj, dest, true);
+      britishMuseum(house, s, d, true);
       break;
-    case 8:
-      hillclimbing(hstart, hgoal, G);
+    case 8: {
+      int mode;
+      std::cout << "Mode (1 steepest ascent, 2 first choice, 3 random "
+                   "restart, 4 simulated annealing): ";
+      std::cin >> mode;
+      HillClimbOptions opts;
+      opts.mode = HillClimbMode(std::clamp(mode, 1, 4) - 1);
+      hillClimbEngine(house, s, d, opts, &pool);
       break;
+    }
     case 9:
-      beamsearch(hstart, hgoal, G, beamwidth);
+      beamsearch(house, s, d, beamwidth);
       break;
     case 10:
-      bestFirstSearch(hstart, hgoal, G);
+      bestFirstSearch(house, s, d);
       break;
     case 11: {
-      run_all_algorithms(src, dest, adj, hstart, hgoal, G, beamwidth,
-                         std::cout);
-      std::ofstream fout("output.txt");
+      // One run of every search, written to the console, output.txt and,
+      // with its measured cost, output.jsonl.
+      std::vector<ReportSection> report = runAllAlgorithms(
+          house, s, d, house, s, d, beamwidth, routes, &pool, true);
+      writeReport(report, std::cout);
+      OutputFile fout("output.txt");
       if (fout.is_open()) {
-        run_all_algorithms(src, dest, adj, hstart, hgoal, G, beamwidth, fout);
+        writeReport(report, fout);
         fout.close();
         std::cout << "Output written to output.txt\n";
       } else {
         std::cout << "Failed to open output.txt\n";
       }
+      OutputFile json("output.jsonl");
+      if (json.is_open()) {
+        writeReportJson(report, json);
+        json.close();
+        std::cout << "Metrics written to output.jsonl\n";
+      } else {
+        std::cout << "Failed to open output.jsonl\n";
+      }
       break;
     }
     case 12:
       helperFunction();
       break;
     case 13: {
-      std::ofstream fout("output.txt");
+      OutputFile fout("output.txt");
       if (!fout.is_open()) {
         std::cout << "Failed to open output.txt\n";
         break;
       }
-      run_all_algorithms(src, dest, adj, hstart, hgoal, G, beamwidth, fout);
+      writeReport(runAllAlgorithms(house, s, d, house, s, d, beamwidth, routes,
+                                   &pool),
+                  fout);
       fout.close();
       std::cout << "Output written to output.txt\n";
       break;
     }
     case 14:
       break;
+    case 15:
+      directionOptimizingBFS(house, houseIn, s, d);
+      break;
+    case 16:
+      parallelBFS(house, s, d, pool);
+      break;
+    case 17:
+      parallelBiBFS(house, s, d, pool);
+      break;
+    case 18:
+      aStar(house, s, d);
+      break;
+    case 19:
+      idaStar(house, s, d);
+      break;
+    case 20:
+      contractionHierarchy(house, hierarchy, s, d);
+      break;
+    case 21:
+      dijkstra(house, s, d);
+      break;
+    case 22:
+      std::cout << "Enter k: ";
+      std::cin >> routes;
+      kShortestPaths(house, s, d, routes);
+      break;
+    case 23:
+      replanSession(house, s, d);
+      break;
+    case 24: {
+      long long perTick;
+      std::cout << "Expansions per tick: ";
+      std::cin >> perTick;
+      anytimeAStar(house, s, d, perTick);
+      break;
+    }
     default:
       std::cout << "Invalid choice.\n";
     }
@@ -0,0 +1,160 @@
+/*
+
+    Block-buffered output for the printers.
+
+    Every printer in this project writes to a std::ostream and ends lines
+   with "\n", never std::endl, so nothing flushes per line. What a dump
+   costs then depends on the stream buffer underneath it:
+
+      BufferedOutput  a std::streambuf that fills one large block (64 KiB
+   by default) and hands it to a file descriptor with write(2) when the block
+   is full, on flush, and on destruction. Writes larger than a block skip
+   the copy and go straight to the descriptor.
+      OutputFile      a std::ostream over a BufferedOutput, either on a
+   descriptor it is given (left open) or on a file it creates or truncates
+   (closed with the stream).
+      BufferedStdout  puts a BufferedOutput on descriptor 1 under std::cout
+   for as long as it lives, so everything printed to std::cout, including
+   by the printers' default arguments, goes through one block. std::cin
+   stays tied to std::cout, so prompts still show before each read.
+
+    A failed write marks the buffer bad and the stream's next flush fails;
+   later output is dropped.
+*/
+
+#pragma once
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <streambuf>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+class BufferedOutput : public std::streambuf {
+public:
+  static constexpr size_t kDefaultBlock = size_t(1) << 16;
+
+  explicit BufferedOutput(int fd, size_t block = kDefaultBlock)
+      : fd(fd), block(std::max<size_t>(block, 1)) {
+    setp(this->block.data(), this->block.data() + this->block.size());
+  }
+  BufferedOutput(const BufferedOutput &) = delete;
+  BufferedOutput &operator=(const BufferedOutput &) = delete;
+  ~BufferedOutput() override { drain(); }
+
+  bool good() const { return !failed; }
+
+protected:
+  int_type overflow(int_type c) override {
+    if (!drain())
+      return traits_type::eof();
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+      *pptr() = traits_type::to_char_type(c);
+      pbump(1);
+    }
+    return traits_type::not_eof(c);
+  }
+
+  std::streamsize xsputn(const char *s, std::streamsize n) override {
+    if (n > epptr() - pptr()) {
+      if (!drain())
+        return 0;
+      if (size_t(n) >= block.size())
+        return writeAll(s, size_t(n)) ? n : 0;
+    }
+    std::memcpy(pptr(), s, size_t(n));
+    pbump(int(n));
+    return n;
+  }
+
+  int sync() override { return drain() ? 0 : -1; }
+
+private:
+  int fd;
+  std::vector<char> block;
+  bool failed = false;
+
+  // Writes out the filled part of the block and starts it over.
+  bool drain() {
+    size_t n = size_t(pptr() - pbase());
+    setp(block.data(), block.data() + block.size());
+    return n == 0 || writeAll(block.data(), n);
+  }
+
+  bool writeAll(const char *p, size_t n) {
+    while (n > 0 && !failed) {
+      ssize_t w = ::write(fd, p, n);
+      if (w < 0 && errno == EINTR)
+        continue;
+      if (w <= 0) {
+        failed = true;
+        break;
+      }
+      p += w;
+      n -= size_t(w);
+    }
+    return !failed;
+  }
+};
+
+class OutputFile : public std::ostream {
+public:
+  // Writes to `fd`, which the caller keeps open and closes.
+  explicit OutputFile(int fd, size_t block = BufferedOutput::kDefaultBlock)
+      : std::ostream(nullptr), fd(fd), buf(fd, block) {
+    rdbuf(&buf);
+  }
+
+  // Creates or truncates `path`; check is_open().
+  explicit OutputFile(const std::string &path,
+                      size_t block = BufferedOutput::kDefaultBlock)
+      : OutputFile(::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644),
+                   block) {
+    owned = fd >= 0;
+    if (!owned)
+      setstate(std::ios::badbit);
+  }
+
+  ~OutputFile() override { close(); }
+
+  bool is_open() const { return fd >= 0; }
+
+  // Flushes, and closes the file if this stream opened it.
+  void close() {
+    if (fd < 0)
+      return;
+    flush();
+    if (owned)
+      ::close(fd);
+    fd = -1;
+    rdbuf(nullptr); // later writes fail instead of reaching a reused fd
+  }
+
+private:
+  int fd;
+  BufferedOutput buf;
+  bool owned = false;
+};
+
+class BufferedStdout {
+public:
+  explicit BufferedStdout(size_t block = BufferedOutput::kDefaultBlock)
+      : buf(STDOUT_FILENO, block) {
+    std::cout.flush(); // anything already printed goes first
+    previous = std::cout.rdbuf(&buf);
+  }
+  BufferedStdout(const BufferedStdout &) = delete;
+  BufferedStdout &operator=(const BufferedStdout &) = delete;
+  ~BufferedStdout() {
+    std::cout.flush();
+    std::cout.rdbuf(previous);
+  }
+
+private:
+  BufferedOutput buf;
+  std::streambuf *previous;
+};
@@ -0,0 +1,303 @@
+/*
+
+    Multi-threaded BFS variants for large house graphs.
+
+    - parallelBFS: level-synchronous BFS. Each level is cut into chunks that
+   the pool expands with their own output buffers; nodes are claimed in an
+   atomic visited bitmap.
+    - parallelBiBFS: the two frontiers of bidirectional BFS expand at the same
+   time on separate workers and detect the meeting room through atomic
+   depth stamps, without locks.
+
+    Both report the same path and "Nodes expanded" as bfs() / biBFS() in
+   algo.h: within a level every node keeps the parent the serial queue would
+   have given it (earliest frontier position wins), so the next level comes
+   out in serial order. On a pool of one thread parallelBFS is plain bfs().
+    - parallelBeamSearch: beam search whose levels are expanded by the pool
+   in contiguous slices, each with its own path stamps and child buffer.
+   Buffers are joined in slice order, so the beam and the path found are
+   the same as beamsearch() in algo.h.
+*/
+
+#pragma once
+#include "algo.h"
+#include "bitmap.h"
+#include "csr.h"
+#include "thread_pool.h"
+#include <atomic>
+#include <climits>
+#include <iostream>
+#include <vector>
+
+// Frontiers smaller than this are expanded on the calling thread.
+constexpr int kParallelFrontierCutoff = 1024;
+// Beams narrower than this are expanded on the calling thread; each beam
+// entry walks its own path, so the cutoff is lower than for BFS frontiers.
+constexpr int kParallelBeamCutoff = 64;
+
+inline void atomicMin(std::atomic<int> &slot, int value) {
+  int cur = slot.load(std::memory_order_relaxed);
+  while (value < cur &&
+         !slot.compare_exchange_weak(cur, value, std::memory_order_relaxed))
+    ;
+}
+
+inline SearchResult runParallelBFS(const CSRGraph &g, int src, int dest,
+                                   ThreadPool &pool) {
+  // One worker gains nothing from the claim passes and would still pay
+  // for them and for the O(V) owner table.
+  if (pool.size() < 2)
+    return runBFS(g, src, dest);
+  SearchResult r;
+  if (src < 0 || dest < 0)
+    return r;
+  int n = g.size();
+  AtomicBitmap visited(n);
+  std::vector<std::atomic<int>> owner(n);
+  for (auto &o : owner)
+    o.store(INT_MAX, std::memory_order_relaxed);
+  std::vector<int> parent(n, -1);
+  std::vector<int> frontier{src}, next;
+  std::vector<std::vector<int>> chunkOut;
+  visited.claim(src);
+  r.generated = 1;
+  int found = src == dest ? 0 : -1;
+
+  while (found == -1 && !frontier.empty()) {
+    int size = frontier.size();
+    int tasks = pool.size() * 4;
+    int chunk = std::max(64, (size + tasks - 1) / tasks);
+    int chunks = (size + chunk - 1) / chunk;
+    if ((int)chunkOut.size() < chunks)
+      chunkOut.resize(chunks);
+    auto run = [&](const std::function<void(int)> &fn) {
+      if (size < kParallelFrontierCutoff)
+        for (int c = 0; c < chunks; c++)
+          fn(c);
+      else
+        pool.parallelFor(chunks, fn);
+    };
+    // Pass 1: each undiscovered neighbor records the earliest frontier
+    // position that reaches it.
+    run([&](int c) {
+      int end = std::min(size, (c + 1) * chunk);
+      for (int i = c * chunk; i < end; i++)
+        for (int v : g.neighbors(frontier[i]))
+          if (!visited.test(v))
+            atomicMin(owner[v], i);
+    });
+    // Pass 2: the owning position claims it into its chunk's buffer.
+    run([&](int c) {
+      auto &buf = chunkOut[c];
+      buf.clear();
+      int end = std::min(size, (c + 1) * chunk);
+      for (int i = c * chunk; i < end; i++) {
+        int u = frontier[i];
+        for (int v : g.neighbors(u)) {
+          if (owner[v].load(std::memory_order_relaxed) == i &&
+              visited.claim(v)) {
+            parent[v] = u;
+            buf.push_back(v);
+          }
+        }
+      }
+    });
+    next.clear();
+    for (int c = 0; c < chunks; c++)
+      next.insert(next.end(), chunkOut[c].begin(), chunkOut[c].end());
+    r.expanded += size;
+    r.generated += next.size();
+    r.peakFrontier = std::max(r.peakFrontier, size_t(size));
+    if (visited.test(dest))
+      found = int(std::find(next.begin(), next.end(), dest) - next.begin());
+    frontier.swap(next);
+  }
+  if (found == -1)
+    return r;
+  r.expanded += found + 1;
+  r.found = true;
+  r.path = tracePath(parent, dest);
+  return r;
+}
+
+inline void parallelBFS(const CSRGraph &g, int src, int dest, ThreadPool &pool,
+                        std::ostream &out = std::cout) {
+  out << "Parallel BFS:\n";
+  SearchResult r = runParallelBFS(g, src, dest, pool);
+  if (!r.found) {
+    out << "No path found.\n";
+    return;
+  }
+  out << "Path: ";
+  printPath(g, r.path, out);
+  out << "Nodes expanded: " << r.expanded << "\n";
+  out << "Threads: " << pool.size() << "\n";
+}
+
+inline SearchResult runParallelBiBFS(const CSRGraph &g, int src, int dest,
+                                     ThreadPool &pool) {
+  SearchResult r;
+  if (src < 0 || dest < 0)
+    return r;
+  int n = g.size();
+  // depth[s][v]: BFS depth of v from side s (0 = source, 1 = destination),
+  // -1 if undiscovered. Only side s writes it; the other side reads it to
+  // detect the meeting room.
+  std::vector<std::atomic<int>> depth[2] = {std::vector<std::atomic<int>>(n),
+                                            std::vector<std::atomic<int>>(n)};
+  for (auto &side : depth)
+    for (auto &d : side)
+      d.store(-1, std::memory_order_relaxed);
+  std::vector<int> parent[2] = {std::vector<int>(n, -1),
+                                std::vector<int>(n, -1)};
+  std::vector<int> queue[2];
+  size_t head[2] = {0, 0};
+  queue[0].reserve(n);
+  queue[1].reserve(n);
+  queue[0].push_back(src);
+  depth[0][src].store(0, std::memory_order_relaxed);
+  queue[1].push_back(dest);
+  depth[1][dest].store(0, std::memory_order_relaxed);
+  r.generated = 2;
+
+  for (int round = 1; head[0] < queue[0].size() && head[1] < queue[1].size();
+       round++) {
+    size_t levelEnd[2] = {queue[0].size(), queue[1].size()};
+    r.peakFrontier = std::max(r.peakFrontier, (levelEnd[0] - head[0]) +
+                                                  (levelEnd[1] - head[1]));
+    std::atomic<bool> sourceMet{false};
+    size_t stop[2] = {levelEnd[0], levelEnd[1]};
+    pool.parallelFor(2, [&](int s) {
+      const auto &other = depth[1 - s];
+      // Serially the source side expands first, so it can only meet rooms
+      // the destination side found in earlier rounds. The destination side
+      // may also meet rooms the source side finds this round; those are
+      // only known after the barrier and are resolved below.
+      int settled = round - 1;
+      for (size_t i = head[s]; i < levelEnd[s]; i++) {
+        if (s == 1 && sourceMet.load(std::memory_order_relaxed))
+          return;
+        int curr = queue[s][i];
+        int d = other[curr].load(std::memory_order_relaxed);
+        if (d != -1 && d <= settled) {
+          stop[s] = i;
+          if (s == 0)
+            sourceMet.store(true, std::memory_order_relaxed);
+          return;
+        }
+        for (int nbr : g.neighbors(curr)) {
+          if (depth[s][nbr].load(std::memory_order_relaxed) == -1) {
+            depth[s][nbr].store(round, std::memory_order_relaxed);
+            parent[s][nbr] = curr;
+            queue[s].push_back(nbr);
+          }
+        }
+      }
+    });
+    int meet = -1;
+    if (stop[0] < levelEnd[0]) {
+      r.expanded += stop[0] - head[0] + 1;
+      meet = queue[0][stop[0]];
+    } else {
+      r.expanded += levelEnd[0] - head[0];
+      size_t last = std::min(stop[1], levelEnd[1] - 1);
+      for (size_t i = head[1]; i <= last; i++) {
+        int d = depth[0][queue[1][i]].load(std::memory_order_relaxed);
+        if (d != -1 && d <= round) {
+          r.expanded += i - head[1] + 1;
+          meet = queue[1][i];
+          break;
+        }
+      }
+      if (meet == -1)
+        r.expanded += levelEnd[1] - head[1];
+    }
+    r.generated += (queue[0].size() - levelEnd[0]) +
+                   (queue[1].size() - levelEnd[1]);
+    if (meet != -1) {
+      r.found = true;
+      r.path = tracePath(parent[0], meet);
+      for (int u = parent[1][meet]; u != -1; u = parent[1][u])
+        r.path.push_back(u);
+      return r;
+    }
+    head[0] = levelEnd[0];
+    head[1] = levelEnd[1];
+  }
+  return r;
+}
+
+inline void parallelBiBFS(const CSRGraph &g, int src, int dest,
+                          ThreadPool &pool, std::ostream &out = std::cout) {
+  out << "Parallel bidirectional BFS:\n";
+  SearchResult r = runParallelBiBFS(g, src, dest, pool);
+  if (!r.found) {
+    out << "No path found.\n";
+    return;
+  }
+  out << "Path: ";
+  printPath(g, r.path, out);
+  out << "Nodes expanded: " << r.expanded << "\n";
+  out << "Threads: 2\n";
+}
+
+inline SearchResult runParallelBeamSearch(const CSRGraph &g, int start,
+                                          int goal, int beamwidth,
+                                          ThreadPool &pool) {
+  SearchResult r;
+  if (start < 0 || goal < 0)
+    return r;
+  int slices = pool.size();
+  std::vector<NodePath> arena, children;
+  std::vector<int> level, order;
+  std::vector<std::vector<NodePath>> sliceOut(slices);
+  std::vector<std::vector<uint32_t>> marks(slices);
+  std::vector<uint32_t> epochs(slices, 0);
+  arena.emplace_back(start, g.heuristic[start], -1);
+  level.push_back(0);
+  r.generated = 1;
+  while (!level.empty()) {
+    int hit = beamGoal(arena, level, goal);
+    if (hit != -1) {
+      r.expanded += hit + 1;
+      r.path = traceBeam(arena, level[hit]);
+      r.found = true;
+      return r;
+    }
+    size_t size = level.size();
+    r.expanded += size;
+    int used = size < size_t(kParallelBeamCutoff) ? 1 : slices;
+    size_t slice = (size + used - 1) / used;
+    auto expand = [&](int c) {
+      if (marks[c].empty())
+        marks[c].assign(g.size(), 0);
+      sliceOut[c].clear();
+      expandBeam(g, arena, level, std::min(size, c * slice),
+                 std::min(size, (c + 1) * slice), marks[c], epochs[c],
+                 sliceOut[c], ColumnHeuristic{g});
+    };
+    if (used == 1)
+      expand(0);
+    else
+      pool.parallelFor(used, expand);
+    children.clear();
+    for (int c = 0; c < used; c++)
+      children.insert(children.end(), sliceOut[c].begin(), sliceOut[c].end());
+    r.generated += children.size();
+    r.peakFrontier = std::max(r.peakFrontier, children.size());
+    selectBeam(children, beamwidth, arena, level, order);
+  }
+  return r;
+}
+
+inline void parallelBeamSearch(const CSRGraph &g, int start, int goal,
+                               int beamwidth, ThreadPool &pool,
+                               std::ostream &out = std::cout) {
+  SearchResult r = runParallelBeamSearch(g, start, goal, beamwidth, pool);
+  if (!r.found) {
+    out << "No path found\n";
+    return;
+  }
+  out << "Path: ";
+  printPath(g, r.path, out);
+}
@@ -0,0 +1,128 @@
+/*
+
+    Parallel British Museum search: every simple path from start to goal,
+   enumerated on all workers of a ThreadPool.
+
+    Each worker walks a subtree with walkSimplePaths (algo.h). While some
+   worker is idle and nothing is queued, a busy worker gives away the untried
+   doors of its shallowest open room, each as a new subtree (the path so far
+   plus one room), and the idle worker picks it up. Shallow branches are the
+   big ones, so the top levels of the tree end up spread over the workers,
+   and a worker that runs dry gets new work from the others, however lopsided
+   the tree is.
+
+    Paths reach the callback as they are found, from any worker but one at
+   a time, and not in serial order. paths / expanded / generated match
+   runBritishMuseum; `path` is whichever path some worker found first.
+*/
+
+#pragma once
+#include "algo.h"
+#include "bitmap.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+inline BritishMuseumResult
+runParallelBritishMuseum(const CSRGraph &g, int start, int goal,
+                         ThreadPool &pool, const PathCallback &onPath) {
+  BritishMuseumResult total;
+  if (start < 0 || goal < 0)
+    return total;
+  // A subtree still to walk: the rooms leading to it, then its root.
+  struct Branch {
+    std::vector<int> prefix;
+    int root;
+  };
+  int workers = pool.size();
+  std::deque<Branch> branches{{{}, start}};
+  std::mutex mtx; // guards branches, done and total
+  std::condition_variable cv;
+  std::atomic<int> idle{0}, queued{1};
+  bool done = false;
+  std::mutex foundMtx;
+  PathCallback found;
+  if (onPath)
+    found = [&](const std::vector<int> &p) {
+      std::lock_guard<std::mutex> lock(foundMtx);
+      onPath(p);
+    };
+  total.generated = 1;
+
+  pool.parallelFor(workers, [&](int) {
+    BritishMuseumResult r;
+    Bitmap onPathBits(g.size());
+    std::vector<int> path;
+    // Frame i is the room at path[path.size() - frames.size() + i]. The top
+    // frame is never given away, so the donor keeps working.
+    auto split = [&](std::vector<SimplePathFrame> &frames) {
+      if (idle.load(std::memory_order_relaxed) == 0 ||
+          queued.load(std::memory_order_relaxed) > 0)
+        return;
+      size_t prefix = path.size() - frames.size();
+      for (size_t i = 0; i + 1 < frames.size(); i++) {
+        SimplePathFrame &f = frames[i];
+        // onPathBits also holds the rooms past frame i, which a branch
+        // from here may still visit.
+        auto upto = path.begin() + prefix + i + 1;
+        std::vector<Branch> give;
+        for (int end = g.offsets[f.node + 1]; f.next < end; f.next++) {
+          int v = g.targets[f.next];
+          if (onPathBits.test(v) && std::find(path.begin(), upto, v) != upto)
+            continue;
+          r.generated++;
+          give.push_back({std::vector<int>(path.begin(), upto), v});
+        }
+        if (give.empty())
+          continue;
+        {
+          std::lock_guard<std::mutex> lock(mtx);
+          for (Branch &b : give)
+            branches.push_back(std::move(b));
+          queued += int(give.size());
+        }
+        cv.notify_all();
+        return;
+      }
+    };
+
+    while (true) {
+      Branch b;
+      {
+        std::unique_lock<std::mutex> lock(mtx);
+        if (++idle == workers && branches.empty()) {
+          done = true;
+          cv.notify_all();
+        }
+        cv.wait(lock, [&] { return done || !branches.empty(); });
+        if (branches.empty())
+          break;
+        b = std::move(branches.front());
+        branches.pop_front();
+        queued--;
+        idle--;
+      }
+      path = std::move(b.prefix);
+      for (int u : path)
+        onPathBits.set(u);
+      walkSimplePaths(g, b.root, goal, path, onPathBits, found, r, split);
+      for (int u : path)
+        onPathBits.reset(u);
+    }
+
+    std::lock_guard<std::mutex> lock(mtx);
+    total.expanded += r.expanded;
+    total.generated += r.generated;
+    total.paths += r.paths;
+    total.peakFrontier = std::max(total.peakFrontier, r.peakFrontier);
+    if (r.found && !total.found) {
+      total.found = true;
+      total.path = std::move(r.path);
+    }
+  });
+  return total;
+}
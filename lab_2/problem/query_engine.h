@@ -0,0 +1,344 @@
+/*
+
+    Batch path-query engine: load a house graph once, then answer many
+   (source, destination) queries with structured results instead of
+   printed reports.
+
+      QueryEngine engine(g);                 // or engine.load("input.bin")
+      std::vector<QueryResult> out =
+          engine.run({{s1, d1}, {s2, d2}}, QueryAlgorithm::kBFS);
+
+    - Batches are split across a ThreadPool. Each worker owns a
+   SearchWorkspace (search_workspace.h: queues, parent, cost and
+   epoch-stamped visited arrays sized to the graph), so BFS, DFS,
+   bidirectional BFS, best-first and A* queries allocate nothing but their
+   result path, and a short query costs the same on a large map as on a
+   small one. The other algorithms forward to their run* cores in algo.h.
+    - Answers are kept in an LRU cache keyed on (algorithm, source,
+   destination). setGraph() / load() replace the graph and drop the cache;
+   queries already running against the old graph finish on it, but their
+   answers are not cached.
+    - Heuristic algorithms use the graph's heuristic column, which is only
+   meaningful for the goal it was written for, unless landmarks are set
+   (landmarks.h): then every query gets ALT lower bounds for its own goal.
+*/
+
+#pragma once
+#include "algo.h"
+#include "graph_file.h"
+#include "landmarks.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+enum class QueryAlgorithm {
+  kBFS,
+  kBiBFS,
+  kDFS,
+  kAStar,
+  kBestFirst,
+  kBeam,
+  kHillClimbing,
+  kDijkstra
+};
+
+struct PathQuery {
+  int src, dest;
+};
+
+struct QueryResult {
+  bool found = false;
+  std::vector<int> path;
+  long long cost = 0; // sum of door costs along `path`
+  long long expanded = 0;
+  bool cached = false; // answered from the LRU cache
+};
+
+// Cost of the cheapest door from u to v. Bidirectional BFS walks doors
+// from both ends, so a step with only a v -> u door is charged that door.
+inline long long doorCost(const CSRGraph &g, int u, int v) {
+  const long long kNone = std::numeric_limits<long long>::max();
+  long long c = kNone;
+  for (int e = g.offsets[u]; e < g.offsets[u + 1]; e++)
+    if (g.targets[e] == v)
+      c = std::min<long long>(c, g.cost(e));
+  for (int e = g.offsets[v]; c == kNone && e < g.offsets[v + 1]; e++)
+    if (g.targets[e] == u)
+      c = g.cost(e);
+  return c == kNone ? 0 : c;
+}
+
+inline long long pathCost(const CSRGraph &g, const std::vector<int> &path) {
+  long long c = 0;
+  for (size_t i = 0; i + 1 < path.size(); i++)
+    c += doorCost(g, path[i], path[i + 1]);
+  return c;
+}
+
+struct QueryKey {
+  QueryAlgorithm algo;
+  int src, dest;
+  bool operator==(const QueryKey &o) const {
+    return algo == o.algo && src == o.src && dest == o.dest;
+  }
+};
+
+struct QueryKeyHash {
+  size_t operator()(const QueryKey &k) const {
+    uint64_t h = uint64_t(uint32_t(k.src)) << 32 | uint32_t(k.dest);
+    h = (h ^ uint64_t(k.algo)) * 0x9E3779B97F4A7C15ull;
+    return size_t(h ^ h >> 32);
+  }
+};
+
+// Least-recently-used map from a query to its answer.
+class QueryCache {
+public:
+  explicit QueryCache(size_t capacity) : capacity(capacity) {}
+
+  bool get(const QueryKey &key, QueryResult &out) {
+    auto it = index.find(key);
+    if (it == index.end())
+      return false;
+    entries.splice(entries.begin(), entries, it->second);
+    out = it->second->second;
+    return true;
+  }
+
+  void put(const QueryKey &key, const QueryResult &value) {
+    if (capacity == 0)
+      return;
+    auto it = index.find(key);
+    if (it != index.end()) {
+      it->second->second = value;
+      entries.splice(entries.begin(), entries, it->second);
+      return;
+    }
+    if (entries.size() == capacity) {
+      index.erase(entries.back().first);
+      entries.pop_back();
+    }
+    entries.emplace_front(key, value);
+    index[key] = entries.begin();
+  }
+
+  void clear() {
+    entries.clear();
+    index.clear();
+  }
+
+  size_t size() const { return entries.size(); }
+
+private:
+  size_t capacity;
+  std::list<std::pair<QueryKey, QueryResult>> entries;
+  std::unordered_map<QueryKey,
+                     std::list<std::pair<QueryKey, QueryResult>>::iterator,
+                     QueryKeyHash>
+      index;
+};
+
+struct QueryEngineOptions {
+  int threads = 0; // 0 = one per hardware thread
+  size_t cacheSize = 4096;
+  int beamwidth = 2; // for QueryAlgorithm::kBeam
+};
+
+class QueryEngine {
+public:
+  explicit QueryEngine(CSRGraph g = CSRGraph(),
+                       QueryEngineOptions opts = QueryEngineOptions())
+      : opts(opts), pool(opts.threads), scratch(pool.size()),
+        cache(opts.cacheSize) {
+    setGraph(std::move(g));
+  }
+
+  // Loads a text or binary graph file (see loadGraph) and makes it current.
+  bool load(const std::string &filename) {
+    CSRGraph g;
+    if (!loadGraph(filename, g))
+      return false;
+    setGraph(std::move(g));
+    return true;
+  }
+
+  // Replaces the graph; landmarks built for the old one are dropped.
+  void setGraph(CSRGraph g) {
+    std::lock_guard<std::mutex> lock(mtx);
+    current = std::make_shared<const CSRGraph>(std::move(g));
+    landmarks.reset();
+    version++;
+    cache.clear();
+  }
+
+  // Builds k landmarks for the current graph on the engine's pool. Fails
+  // if the graph is replaced while they are being built.
+  bool buildLandmarks(int k) {
+    auto g = graph();
+    return setLandmarks(std::make_shared<const LandmarkIndex>(
+                            ::buildLandmarks(*g, k, pool)),
+                        g);
+  }
+
+  bool loadLandmarks(const std::string &filename) {
+    auto g = graph();
+    auto idx = std::make_shared<LandmarkIndex>();
+    if (!readLandmarkFile(filename, *g, *idx))
+      return false;
+    return setLandmarks(std::move(idx), g);
+  }
+
+  // Attaches landmarks built for `builtFor`. Rejects them unless that is
+  // still the current graph (setGraph() may have replaced it since) and
+  // they have a distance per room of it.
+  bool setLandmarks(std::shared_ptr<const LandmarkIndex> idx,
+                    const std::shared_ptr<const CSRGraph> &builtFor) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (builtFor != current) {
+      std::cout << "Landmarks were built for a graph that has since been "
+                   "replaced.\n";
+      return false;
+    }
+    size_t entries = size_t(current->size()) * size_t(idx->k);
+    if (idx->from.size() != entries || idx->to.size() != entries) {
+      std::cout << "Landmarks do not match the current graph.\n";
+      return false;
+    }
+    landmarks = std::move(idx);
+    version++;
+    cache.clear();
+    return true;
+  }
+
+  std::shared_ptr<const CSRGraph> graph() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return current;
+  }
+
+  // Answers every query in `batch`; results are in the same order. Batches
+  // submitted from several threads run one after another, since they share
+  // the workers' scratch buffers.
+  std::vector<QueryResult> run(const std::vector<PathQuery> &batch,
+                               QueryAlgorithm algo) {
+    std::lock_guard<std::mutex> running(batchMtx);
+    std::shared_ptr<const CSRGraph> g;
+    std::shared_ptr<const LandmarkIndex> lm;
+    uint64_t ver;
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      g = current;
+      lm = landmarks;
+      ver = version;
+    }
+    std::vector<QueryResult> results(batch.size());
+    std::atomic<size_t> next{0};
+    int tasks = std::min<size_t>(scratch.size(), batch.size());
+    // Workers pull queries one at a time so a few slow ones do not leave
+    // the rest of a chunk waiting.
+    pool.parallelFor(tasks, [&](int t) {
+      for (size_t i; (i = next.fetch_add(1)) < batch.size();)
+        results[i] = answer(*g, lm.get(), ver, batch[i], algo, scratch[t]);
+    });
+    return results;
+  }
+
+  QueryResult query(int src, int dest, QueryAlgorithm algo) {
+    return run({{src, dest}}, algo)[0];
+  }
+
+  size_t cachedAnswers() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return cache.size();
+  }
+
+  int threads() const { return pool.size(); }
+
+private:
+  QueryResult answer(const CSRGraph &g, const LandmarkIndex *lm, uint64_t ver,
+                     PathQuery q, QueryAlgorithm algo, SearchWorkspace &s) {
+    if (q.src < 0 || q.dest < 0 || q.src >= g.size() || q.dest >= g.size())
+      return QueryResult();
+    QueryKey key{algo, q.src, q.dest};
+    QueryResult r;
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      if (ver == version && cache.get(key, r)) {
+        r.cached = true;
+        return r;
+      }
+    }
+    r = compute(g, lm, q, algo, s);
+    std::lock_guard<std::mutex> lock(mtx);
+    if (ver == version)
+      cache.put(key, r);
+    return r;
+  }
+
+  QueryResult compute(const CSRGraph &g, const LandmarkIndex *lm,
+                      PathQuery q, QueryAlgorithm algo,
+                      SearchWorkspace &s) const {
+    // With landmarks, h(n) of the heuristic searches is the ALT lower bound
+    // to this query's goal, evaluated only at the rooms they reach.
+    auto bound = [lm, &q](int u) { return lm->lowerBound(u, q.dest); };
+    SearchResult sr;
+    switch (algo) {
+    case QueryAlgorithm::kAStar:
+      sr = lm ? runAStar(g, q.src, q.dest, s, bound)
+              : runAStar(g, q.src, q.dest, s);
+      break;
+    case QueryAlgorithm::kBFS:
+      sr = runBFS(g, q.src, q.dest, s);
+      break;
+    case QueryAlgorithm::kBiBFS:
+      sr = runBiBFS(g, q.src, q.dest, s);
+      break;
+    case QueryAlgorithm::kDFS:
+      sr = runDFS(g, q.src, q.dest, s);
+      break;
+    case QueryAlgorithm::kBestFirst:
+      sr = lm ? runBestFirstSearch(g, q.src, q.dest, s, bound)
+              : runBestFirstSearch(g, q.src, q.dest, s);
+      break;
+    case QueryAlgorithm::kBeam:
+      sr = lm ? runBeamSearch(g, q.src, q.dest, opts.beamwidth, bound)
+              : runBeamSearch(g, q.src, q.dest, opts.beamwidth);
+      break;
+    case QueryAlgorithm::kHillClimbing:
+      sr = lm ? runHillClimbing(g, q.src, q.dest, nullptr, bound)
+              : runHillClimbing(g, q.src, q.dest);
+      break;
+    case QueryAlgorithm::kDijkstra:
+      sr = runDijkstra(g, q.src, q.dest);
+      break;
+    }
+    QueryResult r;
+    r.found = sr.found;
+    r.expanded = sr.expanded;
+    if (sr.found) {
+      r.path = std::move(sr.path);
+      r.cost = algo == QueryAlgorithm::kAStar ? sr.cost : pathCost(g, r.path);
+    }
+    return r;
+  }
+
+  QueryEngineOptions opts;
+  ThreadPool pool;
+  std::vector<SearchWorkspace> scratch; // one per pool task
+  std::mutex batchMtx;                  // one batch uses `scratch` at a time
+  // Guards current, landmarks, version and cache.
+  mutable std::mutex mtx;
+  std::shared_ptr<const CSRGraph> current;
+  std::shared_ptr<const LandmarkIndex> landmarks;
+  uint64_t version = 0;
+  QueryCache cache;
+};
@@ -0,0 +1,101 @@
+/*
+
+    Reusable buffers for the searches in algo.h.
+
+    A search that allocates its visited set and parent table per call pays
+   O(V) to start, however few rooms it reaches. A SearchWorkspace keeps those
+   arrays between calls instead, and marks a room as reached in the current
+   search when its stamp equals the workspace's epoch, so begin() starts a
+   new search with one counter increment. Queues, the DFS stack and the
+   heaps keep their capacity, so after the first few searches a query
+   allocates nothing but the path it returns.
+
+    Every room has a stamp and a parent on each of two sides: side 0 is the
+   search itself, side 1 the backward half of a bidirectional search, or the
+   closed set of A*. Parents and `best` are only meaningful for rooms seen()
+   on that side.
+
+    runBFS, runDFS, runBiBFS, runBestFirstSearch and runAStar take a
+   workspace; their overloads without one make a fresh workspace per call.
+   The spur searches of runKShortestPaths share one per call. A workspace
+   serves one search at a time: give each worker thread its own
+   (QueryEngine does).
+*/
+
+#pragma once
+#include "indexed_heap.h"
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Entry of the best-first frontier: a room, its heuristic and the room it
+// was reached from.
+struct BestFirstEntry {
+  int node;
+  int heuristic;
+  int parent;
+};
+
+class SearchWorkspace {
+public:
+  static constexpr int kSides = 2;
+
+  std::vector<int> queue, queue2;         // BFS; the two halves of biBFS
+  std::vector<std::pair<int, int>> stack; // DFS: (room, room it came from)
+  std::vector<BestFirstEntry> frontier;   // best-first heap storage
+  std::vector<long long> best;            // cost so far, where seen()
+  IndexedHeap<std::pair<long long, long long>> open;
+
+  SearchWorkspace() = default;
+  explicit SearchWorkspace(int n) { begin(n); }
+
+  // Starts a search over rooms 0 .. n-1. O(1) unless n differs from the
+  // last search's, or the epoch wraps.
+  void begin(int n) {
+    if ((int)best.size() != n) {
+      for (int s = 0; s < kSides; s++) {
+        stamp[s].assign(n, 0);
+        parent[s].assign(n, -1);
+      }
+      best.assign(n, 0);
+      open = IndexedHeap<std::pair<long long, long long>>(n);
+      queue.reserve(n);
+      epoch = 0;
+    }
+    if (++epoch == 0) { // wrapped: old stamps could look current
+      for (int s = 0; s < kSides; s++)
+        std::fill(stamp[s].begin(), stamp[s].end(), 0);
+      epoch = 1;
+    }
+    queue.clear();
+    queue2.clear();
+    stack.clear();
+    frontier.clear();
+    open.clear();
+  }
+
+  bool seen(int u, int side = 0) const { return stamp[side][u] == epoch; }
+
+  // Marks u as seen on `side`, reached from `from` (-1 for the root).
+  void see(int u, int from, int side = 0) {
+    stamp[side][u] = epoch;
+    parent[side][u] = from;
+  }
+
+  int parentOf(int u, int side = 0) const { return parent[side][u]; }
+
+  // Rooms from the root of `side` to u.
+  std::vector<int> trace(int u, int side = 0) const {
+    std::vector<int> path;
+    for (; u != -1; u = parent[side][u])
+      path.push_back(u);
+    std::reverse(path.begin(), path.end());
+    return path;
+  }
+
+private:
+  std::vector<uint32_t> stamp[kSides];
+  std::vector<int> parent[kSides];
+  uint32_t epoch = 0;
+};
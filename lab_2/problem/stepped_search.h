@@ -0,0 +1,288 @@
+/*
+
+    Searches that run a few expansions at a time, for a control loop with a
+   fixed budget per tick.
+
+    The run* searches in algo.h go to completion inside one call. SteppedBFS,
+   SteppedBestFirst and SteppedAStar are runBFS, runBestFirstSearch and
+   runAStar as explicit state machines: the frontier, the visited stamps and
+   the parents stay in the object's SearchWorkspace between calls, so a
+   search can stop after any expansion and pick up there on the next tick.
+   (C++20 coroutines would hide the same state in a coroutine frame; the
+   project builds as C++17.)
+
+      step(n)        expands up to n more rooms
+      runUntil(s, t) steps s until the steady-clock deadline t, reading the
+   clock every kClockStride expansions
+      status()       kRunning, kFound or kExhausted
+      result()       counters so far; the path (and cost for A*) once found
+      partialPath()  the route to the expanded room with the smallest
+   heuristic (the first one on ties), i.e. where to head if the tick ends
+   now; the found path once there is one
+      restart(s, t)  starts over on the same graph without reallocating
+
+    Stepped to the end, each one returns the same path and counters as its
+   run* counterpart.
+
+    Usage:
+      SteppedAStar search(house, start, goal);
+      while (runUntil(search, tickDeadline) == StepStatus::kRunning) {
+        follow(search.partialPath());
+        tickDeadline += tick; // resumes where it stopped
+      }
+*/
+
+#pragma once
+#include "algo.h"
+#include "csr.h"
+#include "search_workspace.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+enum class StepStatus { kRunning, kFound, kExhausted };
+
+// Expansions between clock reads in runUntil.
+constexpr long long kClockStride = 64;
+
+// State shared by the stepped searches; not used on its own.
+class SteppedSearch {
+public:
+  StepStatus status() const { return state; }
+  const SearchResult &result() const { return r; }
+  int start() const { return startRoom; }
+  int goal() const { return goalRoom; }
+
+  std::vector<int> partialPath() const {
+    if (r.found)
+      return r.path;
+    return closest < 0 ? std::vector<int>() : ws.trace(closest);
+  }
+
+protected:
+  explicit SteppedSearch(const CSRGraph &g) : g(g) {}
+
+  // Starts a search from `start` to `goal`.
+  void begin(int start, int goal) {
+    r = SearchResult();
+    startRoom = start;
+    goalRoom = goal;
+    closest = -1;
+    bool valid = start >= 0 && goal >= 0;
+    state = valid ? StepStatus::kRunning : StepStatus::kExhausted;
+    if (valid)
+      ws.begin(g.size());
+  }
+
+  // Counts the expansion of u and keeps the closest room expanded so far.
+  void expand(int u) {
+    r.expanded++;
+    if (closest < 0 || g.heuristic[u] < g.heuristic[closest])
+      closest = u;
+  }
+
+  void finish(int goalReached) {
+    r.found = true;
+    r.path = ws.trace(goalReached);
+    state = StepStatus::kFound;
+  }
+
+  const CSRGraph &g;
+  SearchWorkspace ws;
+  SearchResult r;
+  StepStatus state = StepStatus::kExhausted;
+  int startRoom = -1, goalRoom = -1;
+  int closest = -1; // expanded room with the smallest heuristic
+};
+
+class SteppedBFS : public SteppedSearch {
+public:
+  SteppedBFS(const CSRGraph &g, int start, int goal) : SteppedSearch(g) {
+    restart(start, goal);
+  }
+
+  void restart(int start, int goal) {
+    begin(start, goal);
+    head = 0;
+    if (state != StepStatus::kRunning)
+      return;
+    ws.queue.push_back(start);
+    ws.see(start, -1);
+    r.generated = 1;
+  }
+
+  StepStatus step(long long n) {
+    std::vector<int> &queue = ws.queue;
+    for (; n > 0 && state == StepStatus::kRunning; n--) {
+      r.peakFrontier = std::max(r.peakFrontier, queue.size() - head);
+      int curr = queue[head++];
+      expand(curr);
+      if (curr == goalRoom) {
+        finish(curr);
+        break;
+      }
+      for (int nbr : g.neighbors(curr)) {
+        if (!ws.seen(nbr)) {
+          ws.see(nbr, curr);
+          queue.push_back(nbr);
+          r.generated++;
+        }
+      }
+      if (head == queue.size())
+        state = StepStatus::kExhausted;
+    }
+    return state;
+  }
+
+private:
+  size_t head = 0;
+};
+
+class SteppedBestFirst : public SteppedSearch {
+public:
+  SteppedBestFirst(const CSRGraph &g, int start, int goal)
+      : SteppedSearch(g) {
+    restart(start, goal);
+  }
+
+  void restart(int start, int goal) {
+    begin(start, goal);
+    if (state != StepStatus::kRunning)
+      return;
+    push(start, -1);
+    r.generated = 1;
+  }
+
+  StepStatus step(long long n) {
+    std::vector<BestFirstEntry> &pq = ws.frontier;
+    while (n > 0 && state == StepStatus::kRunning) {
+      if (pq.empty()) {
+        state = StepStatus::kExhausted;
+        break;
+      }
+      r.peakFrontier = std::max(r.peakFrontier, pq.size());
+      std::pop_heap(pq.begin(), pq.end(), later);
+      BestFirstEntry current = pq.back();
+      pq.pop_back();
+      if (ws.seen(current.node))
+        continue;
+      ws.see(current.node, current.parent);
+      expand(current.node);
+      n--;
+      if (current.node == goalRoom) {
+        finish(current.node);
+        break;
+      }
+      for (int neighbor : g.neighbors(current.node)) {
+        if (!ws.seen(neighbor)) {
+          push(neighbor, current.node);
+          r.generated++;
+        }
+      }
+    }
+    if (state == StepStatus::kRunning && pq.empty())
+      state = StepStatus::kExhausted;
+    return state;
+  }
+
+private:
+  // The heap order of runBestFirstSearch.
+  static bool later(const BestFirstEntry &a, const BestFirstEntry &b) {
+    return a.heuristic > b.heuristic;
+  }
+
+  void push(int node, int parent) {
+    ws.frontier.push_back({node, g.heuristic[node], parent});
+    std::push_heap(ws.frontier.begin(), ws.frontier.end(), later);
+  }
+};
+
+// Side 1 of the workspace is the closed set, as in runAStar.
+class SteppedAStar : public SteppedSearch {
+public:
+  SteppedAStar(const CSRGraph &g, int start, int goal) : SteppedSearch(g) {
+    restart(start, goal);
+  }
+
+  void restart(int start, int goal) {
+    begin(start, goal);
+    if (state != StepStatus::kRunning)
+      return;
+    ws.see(start, -1);
+    ws.best[start] = 0;
+    ws.open.push(start, {g.heuristic[start], 0});
+    r.generated = 1;
+  }
+
+  StepStatus step(long long n) {
+    std::vector<long long> &best = ws.best;
+    IndexedHeap<std::pair<long long, long long>> &open = ws.open;
+    for (; n > 0 && state == StepStatus::kRunning; n--) {
+      r.peakFrontier = std::max(r.peakFrontier, open.size());
+      int u = open.pop();
+      expand(u);
+      if (ws.seen(u, 1))
+        r.reexpanded++;
+      ws.see(u, -1, 1);
+      if (u == goalRoom) {
+        r.cost = best[u];
+        finish(u);
+        break;
+      }
+      for (int e = g.offsets[u]; e < g.offsets[u + 1]; e++) {
+        int v = g.targets[e];
+        long long cand = best[u] + g.cost(e);
+        if (ws.seen(v) && cand >= best[v])
+          continue;
+        ws.see(v, u);
+        best[v] = cand;
+        open.pushOrDecrease(v, {cand + g.heuristic[v], -cand});
+        r.generated++;
+      }
+      if (open.empty())
+        state = StepStatus::kExhausted;
+    }
+    return state;
+  }
+};
+
+// Steps `search` until it finishes or the deadline passes. The clock is
+// read every kClockStride expansions, so the call can overrun the deadline
+// by that many expansions.
+template <class Search>
+inline StepStatus runUntil(Search &search,
+                           std::chrono::steady_clock::time_point deadline) {
+  while (search.step(kClockStride) == StepStatus::kRunning)
+    if (std::chrono::steady_clock::now() >= deadline)
+      break;
+  return search.status();
+}
+
+// A* run `perTick` expansions at a time, printing where the robot would
+// head after each tick.
+inline SearchResult anytimeAStar(const CSRGraph &g, int start, int goal,
+                                 long long perTick,
+                                 std::ostream &out = std::cout) {
+  SteppedAStar search(g, start, goal);
+  int ticks = 0;
+  while (search.status() == StepStatus::kRunning) {
+    search.step(std::max(1LL, perTick));
+    ticks++;
+    if (search.status() != StepStatus::kRunning)
+      break;
+    out << "Tick " << ticks << ": " << search.result().expanded
+        << " expanded, heading: ";
+    printPath(g, search.partialPath(), out);
+  }
+  const SearchResult &r = search.result();
+  if (!r.found) {
+    out << "No path found after " << ticks << " ticks\n";
+    return r;
+  }
+  out << "Path: ";
+  printPath(g, r.path, out);
+  out << "Path cost: " << r.cost << "\n";
+  out << "Nodes expanded: " << r.expanded << " over " << ticks << " ticks\n";
+  return r;
+}
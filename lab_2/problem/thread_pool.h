@@ -0,0 +1,106 @@
+/*
+
+    Fixed-size worker pool shared by the parallel searches.
+
+    submit()       queue one job, get a future for its result
+    parallelFor()  run fn(0) .. fn(tasks-1) on the workers and wait
+
+    Jobs must not call back into the same pool and wait on it; the workers
+   would all end up blocked on each other.
+*/
+
+#pragma once
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+class ThreadPool {
+public:
+  // threads == 0 uses one worker per hardware thread.
+  explicit ThreadPool(int threads = 0) {
+    if (threads <= 0)
+      threads = std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 0; i < threads; i++)
+      workers.emplace_back([this] { workerLoop(); });
+  }
+
+  ~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      stopping = true;
+    }
+    cv.notify_all();
+    for (auto &w : workers)
+      w.join();
+  }
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  int size() const { return int(workers.size()); }
+
+  template <class F> auto submit(F f) -> std::future<decltype(f())> {
+    using R = decltype(f());
+    auto task = std::make_shared<std::packaged_task<R()>>(std::move(f));
+    std::future<R> result = task->get_future();
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      jobs.emplace([task] { (*task)(); });
+    }
+    cv.notify_one();
+    return result;
+  }
+
+  void parallelFor(int tasks, const std::function<void(int)> &fn) {
+    if (tasks <= 0)
+      return;
+    if (tasks == 1) {
+      fn(0);
+      return;
+    }
+    int remaining = tasks;
+    std::mutex doneMtx;
+    std::condition_variable doneCv;
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      for (int i = 0; i < tasks; i++)
+        jobs.emplace([&, i] {
+          fn(i);
+          std::lock_guard<std::mutex> done(doneMtx);
+          if (--remaining == 0)
+            doneCv.notify_one();
+        });
+    }
+    cv.notify_all();
+    std::unique_lock<std::mutex> lock(doneMtx);
+    doneCv.wait(lock, [&] { return remaining == 0; });
+  }
+
+private:
+  void workerLoop() {
+    while (true) {
+      std::function<void()> job;
+      {
+        std::unique_lock<std::mutex> lock(mtx);
+        cv.wait(lock, [this] { return stopping || !jobs.empty(); });
+        if (jobs.empty())
+          return;
+        job = std::move(jobs.front());
+        jobs.pop();
+      }
+      job();
+    }
+  }
+
+  std::vector<std::thread> workers;
+  std::queue<std::function<void()>> jobs;
+  std::mutex mtx;
+  std::condition_variable cv;
+  bool stopping = false;
+};